@@ -1,19 +1,425 @@
 #include "cobs/c_cobs.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define COBS_X86_SIMD
+#include <immintrin.h>
+#endif
 
 static const uint8_t kCobsDelimiter = 0x00;
 
+// Input is CRCed and encoded in chunks of this size so it is only read from memory once.
+static const size_t kCobsCrcChunk = 1024;
+
+// COBS/ZPE code bytes.  Codes below kCobsZpeNoZero are followed by a single zero like COBS, codes
+// above by a pair.
+static const uint8_t kCobsZpeNoZero = 0xE0;
+static const uint8_t kCobsZpeMaxPairRun = 0xFF - kCobsZpeNoZero - 1;
+
+typedef struct {
+  const char *name;
+  bool (*supported)(void);
+  // Index of the first delimiter in "input" or "len" if there is none.  NULL for byte at a time
+  // processing.
+  size_t (*find_delim)(const uint8_t *input, size_t len);
+  // Copy "input" to "output" up to the first delimiter and return the index of the delimiter or
+  // "len" if there is none.  May write up to "len" bytes to "output" regardless.
+  size_t (*copy_run)(uint8_t *output, const uint8_t *input, size_t len);
+} CobsKernelImpl;
+
+static bool CobsAlwaysSupported(void) { return true; }
+
+static size_t CobsFindDelimSwar(const uint8_t *input, size_t len) {
+  static const uint64_t kOnes = 0x0101010101010101;
+  static const uint64_t kHighs = 0x8080808080808080;
+
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, input + i, sizeof(word));
+    // Non-zero if any byte of "word" is zero.
+    if ((word - kOnes) & ~word & kHighs) {
+      break;
+    }
+  }
+
+  while (i < len && input[i] != kCobsDelimiter) {
+    ++i;
+  }
+  return i;
+}
+
+#ifdef COBS_X86_SIMD
+// SSE2 is part of x86-64.
+static bool CobsSse2Supported(void) { return true; }
+
+// Also called from the load time constructor, which may run before libgcc has detected the CPU.
+static bool CobsAvx2Supported(void) {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+// The vector kernels finish with one block ending at "len" that overlaps the blocks already
+// scanned, ignoring matches in the overlap, instead of a byte at a time tail.  Shorter inputs fall
+// back to bytes.  The copy variants store each block while scanning it so the run is read once.
+
+static size_t CobsFindDelimSse2(const uint8_t *input, size_t len) {
+  const __m128i zero = _mm_setzero_si128();
+  if (len < sizeof(__m128i)) {
+    return CobsFindDelimSwar(input, len);
+  }
+
+  size_t i = 0;
+  for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+    const __m128i data = _mm_loadu_si128((const __m128i *)(input + i));
+    const unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(data, zero));
+    if (mask) {
+      return i + (size_t)__builtin_ctz(mask);
+    }
+  }
+
+  if (i == len) {
+    return len;
+  }
+  const size_t last = len - sizeof(__m128i);
+  const __m128i data = _mm_loadu_si128((const __m128i *)(input + last));
+  const unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(data, zero)) >> (i - last);
+  return mask ? i + (size_t)__builtin_ctz(mask) : len;
+}
+
+static size_t CobsCopyRunSse2(uint8_t *output, const uint8_t *input, size_t len) {
+  const __m128i zero = _mm_setzero_si128();
+  if (len < sizeof(__m128i)) {
+    const size_t run = CobsFindDelimSwar(input, len);
+    memcpy(output, input, run);
+    return run;
+  }
+
+  size_t i = 0;
+  for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+    const __m128i data = _mm_loadu_si128((const __m128i *)(input + i));
+    _mm_storeu_si128((__m128i *)(output + i), data);
+    const unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(data, zero));
+    if (mask) {
+      return i + (size_t)__builtin_ctz(mask);
+    }
+  }
+
+  if (i == len) {
+    return len;
+  }
+  const size_t last = len - sizeof(__m128i);
+  const __m128i data = _mm_loadu_si128((const __m128i *)(input + last));
+  _mm_storeu_si128((__m128i *)(output + last), data);
+  const unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(data, zero)) >> (i - last);
+  return mask ? i + (size_t)__builtin_ctz(mask) : len;
+}
+
+#define COBS_AVX2_TARGET __attribute__((target("avx2")))
+
+COBS_AVX2_TARGET static size_t CobsFindDelimAvx2(const uint8_t *input, size_t len) {
+  const __m256i zero = _mm256_setzero_si256();
+  if (len < sizeof(__m256i)) {
+    return CobsFindDelimSwar(input, len);
+  }
+
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+    const __m256i data = _mm256_loadu_si256((const __m256i *)(input + i));
+    const unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, zero));
+    if (mask) {
+      return i + (size_t)__builtin_ctz(mask);
+    }
+  }
+
+  if (i == len) {
+    return len;
+  }
+  const size_t last = len - sizeof(__m256i);
+  const __m256i data = _mm256_loadu_si256((const __m256i *)(input + last));
+  const unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, zero)) >> (i - last);
+  return mask ? i + (size_t)__builtin_ctz(mask) : len;
+}
+
+COBS_AVX2_TARGET static size_t CobsCopyRunAvx2(uint8_t *output, const uint8_t *input, size_t len) {
+  const __m256i zero = _mm256_setzero_si256();
+  if (len < sizeof(__m256i)) {
+    const size_t run = CobsFindDelimSwar(input, len);
+    memcpy(output, input, run);
+    return run;
+  }
+
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+    const __m256i data = _mm256_loadu_si256((const __m256i *)(input + i));
+    _mm256_storeu_si256((__m256i *)(output + i), data);
+    const unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, zero));
+    if (mask) {
+      return i + (size_t)__builtin_ctz(mask);
+    }
+  }
+
+  if (i == len) {
+    return len;
+  }
+  const size_t last = len - sizeof(__m256i);
+  const __m256i data = _mm256_loadu_si256((const __m256i *)(input + last));
+  _mm256_storeu_si256((__m256i *)(output + last), data);
+  const unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, zero)) >> (i - last);
+  return mask ? i + (size_t)__builtin_ctz(mask) : len;
+}
+#else
+static bool CobsSse2Supported(void) { return false; }
+
+static bool CobsAvx2Supported(void) { return false; }
+
+#define CobsFindDelimSse2 CobsFindDelimSwar
+#define CobsFindDelimAvx2 CobsFindDelimSwar
+#define CobsCopyRunSse2 CobsCopyRunSwar
+#define CobsCopyRunAvx2 CobsCopyRunSwar
+#endif
+
+static size_t CobsCopyRunSwar(uint8_t *output, const uint8_t *input, size_t len) {
+  const size_t run = CobsFindDelimSwar(input, len);
+  memcpy(output, input, run);
+  return run;
+}
+
+// Ordered slowest to fastest.
+static const CobsKernelImpl kCobsKernels[kNumCobsKernel] = {
+    [kCobsKernelScalar] = {"scalar", CobsAlwaysSupported, NULL, NULL},
+    [kCobsKernelSwar] = {"swar", CobsAlwaysSupported, CobsFindDelimSwar, CobsCopyRunSwar},
+    [kCobsKernelSse2] = {"sse2", CobsSse2Supported, CobsFindDelimSse2, CobsCopyRunSse2},
+    [kCobsKernelAvx2] = {"avx2", CobsAvx2Supported, CobsFindDelimAvx2, CobsCopyRunAvx2},
+};
+
+// Replaced with the fastest supported kernel at load time.
+static const CobsKernelImpl *g_cobs_kernel = &kCobsKernels[kCobsKernelSwar];
+
+#ifdef __GNUC__
+__attribute__((constructor)) static void CobsKernelInit(void) {
+  for (int kernel = kNumCobsKernel - 1; kernel >= 0; --kernel) {
+    if (CobsSetKernel((CobsKernel)kernel)) {
+      return;
+    }
+  }
+}
+#endif
+
+CobsKernel CobsGetKernel(void) { return (CobsKernel)(g_cobs_kernel - kCobsKernels); }
+
+const char *CobsKernelName(CobsKernel kernel) {
+  if (kernel < 0 || kernel >= kNumCobsKernel) {
+    return "unknown";
+  }
+  return kCobsKernels[kernel].name;
+}
+
+bool CobsKernelSupported(CobsKernel kernel) {
+  return kernel >= 0 && kernel < kNumCobsKernel && kCobsKernels[kernel].supported();
+}
+
+bool CobsSetKernel(CobsKernel kernel) {
+  if (!CobsKernelSupported(kernel)) {
+    return false;
+  }
+  g_cobs_kernel = &kCobsKernels[kernel];
+  return true;
+}
+
+static double CobsSeconds(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+CobsKernel CobsAutotune(void) {
+  static const int kRounds = 8;
+  uint8_t input[4096];
+  uint8_t encoded[COBS_MAX_ENCODE_LEN(sizeof(input))];
+  uint8_t decoded[sizeof(input)];
+  for (size_t i = 0; i < sizeof(input); ++i) {
+    input[i] = i % 97 ? (uint8_t)(i * 131) | 1 : 0;
+  }
+
+  const CobsKernelImpl *original = g_cobs_kernel;
+  CobsKernel best = CobsGetKernel();
+  double best_time = -1.0;
+
+  for (int kernel = 0; kernel < kNumCobsKernel; ++kernel) {
+    if (!CobsKernelSupported((CobsKernel)kernel)) {
+      continue;
+    }
+    g_cobs_kernel = &kCobsKernels[kernel];
+
+    // Best of several rounds to reject preemption and cold caches.
+    double time = 0.0;
+    for (int round = 0; round < kRounds; ++round) {
+      const double start = CobsSeconds();
+      const size_t encoded_len = CobsEncodeBuffer(encoded, input, sizeof(input));
+      size_t decoded_len = sizeof(decoded);
+      CobsDecodeBuffer(decoded, &decoded_len, encoded, encoded_len);
+      const double elapsed = CobsSeconds() - start;
+      if (round == 0 || elapsed < time) {
+        time = elapsed;
+      }
+    }
+
+    if (best_time < 0.0 || time < best_time) {
+      best = (CobsKernel)kernel;
+      best_time = time;
+    }
+  }
+
+  g_cobs_kernel = original;
+  CobsSetKernel(best);
+  return best;
+}
+
+static void CobsCrcInit(CobsCrc *crc, const void *info, uint8_t bits) {
+  crc->info = info;
+  crc->bits = bits;
+  switch (bits) {
+    case 8:
+      crc->crc = ((const Crc8Info *)info)->initial_crc;
+      break;
+    case 16:
+      crc->crc = ((const Crc16Info *)info)->initial_crc;
+      break;
+    case 32:
+      crc->crc = ((const Crc32Info *)info)->initial_crc;
+      break;
+    default:
+      crc->crc = 0;
+      break;
+  }
+}
+
+static void CobsCrcUpdate(CobsCrc *crc, const uint8_t *input, size_t len) {
+  switch (crc->bits) {
+    case 8:
+      crc->crc = Crc8Seq(crc->info, input, len, (uint8_t)crc->crc);
+      break;
+    case 16:
+      crc->crc = Crc16Seq(crc->info, input, len, (uint16_t)crc->crc);
+      break;
+    case 32:
+      crc->crc = Crc32Seq(crc->info, input, len, crc->crc);
+      break;
+    default:
+      break;
+  }
+}
+
+static inline void CobsCrcUpdateByte(CobsCrc *crc, uint8_t byte) {
+  switch (crc->bits) {
+    case 8:
+      crc->crc = Crc8Update(crc->info, (uint8_t)crc->crc, byte);
+      break;
+    case 16:
+      crc->crc = Crc16Update(crc->info, (uint16_t)crc->crc, byte);
+      break;
+    case 32:
+      crc->crc = Crc32Update(crc->info, crc->crc, byte);
+      break;
+    default:
+      break;
+  }
+}
+
+// Write the final CRC in transmission order.  Returns the number of bytes written.
+static size_t CobsCrcFinal(const CobsCrc *crc, uint8_t *output) {
+  uint32_t value;
+  bool lsb_first;
+  switch (crc->bits) {
+    case 8:
+      value = ((const Crc8Info *)crc->info)->final_xor ^ crc->crc;
+      lsb_first = ((const Crc8Info *)crc->info)->lsb_first;
+      break;
+    case 16:
+      value = ((const Crc16Info *)crc->info)->final_xor ^ crc->crc;
+      lsb_first = ((const Crc16Info *)crc->info)->lsb_first;
+      break;
+    case 32:
+      value = ((const Crc32Info *)crc->info)->final_xor ^ crc->crc;
+      lsb_first = ((const Crc32Info *)crc->info)->lsb_first;
+      break;
+    default:
+      return 0;
+  }
+
+  const size_t len = crc->bits / 8;
+  for (size_t i = 0; i < len; ++i) {
+    const size_t shift = 8 * (lsb_first ? i : len - 1 - i);
+    output[i] = (uint8_t)(value >> shift);
+  }
+  return len;
+}
+
+// Whether "crc" has run over a message followed by its CRC.  Appending the CRC in transmission
+// order always leaves the same residue in the register, found here from the empty message.
+static bool CobsCrcCheck(const CobsCrc *crc) {
+  CobsCrc empty;
+  CobsCrcInit(&empty, crc->info, crc->bits);
+  uint8_t bytes[sizeof(uint32_t)];
+  CobsCrcUpdate(&empty, bytes, CobsCrcFinal(&empty, bytes));
+  return crc->crc == empty.crc;
+}
+
+// Index of the first delimiter in "input" or "len" if there is none, with any kernel.
+static size_t CobsFindDelim(const uint8_t *input, size_t len) {
+  if (g_cobs_kernel->find_delim) {
+    return g_cobs_kernel->find_delim(input, len);
+  }
+
+  size_t i = 0;
+  while (i < len && input[i] != kCobsDelimiter) {
+    ++i;
+  }
+  return i;
+}
+
 void CobsEncodeStateInit(CobsEncodeState *state, uint8_t *output_buf) {
   state->encoded = output_buf;
   state->len = 0;
   state->_delim_ptr = output_buf;
   state->_write_ptr = output_buf + 1;
   state->_delim_cnt = 1;
+  CobsCrcInit(&state->_crc, NULL, 0);
+  state->_mode = kCobsModeStandard;
+  state->_zero_pending = false;
 }
 
-void CobsEncodeBlock(CobsEncodeState *state, const uint8_t *input_buf, size_t len, bool finalize) {
+void CobsEncodeStateInitCrc8(CobsEncodeState *state, uint8_t *output_buf, const Crc8Info *info) {
+  CobsEncodeStateInit(state, output_buf);
+  CobsCrcInit(&state->_crc, info, 8);
+}
+
+void CobsEncodeStateInitCrc16(CobsEncodeState *state, uint8_t *output_buf, const Crc16Info *info) {
+  CobsEncodeStateInit(state, output_buf);
+  CobsCrcInit(&state->_crc, info, 16);
+}
+
+void CobsEncodeStateInitCrc32(CobsEncodeState *state, uint8_t *output_buf, const Crc32Info *info) {
+  CobsEncodeStateInit(state, output_buf);
+  CobsCrcInit(&state->_crc, info, 32);
+}
+
+void CobsEncodeStateSetMode(CobsEncodeState *state, CobsMode mode) { state->_mode = mode; }
+
+// End the current group with "code" and start the next.
+static inline void CobsEncodeCode(CobsEncodeState *state, uint8_t code) {
+  *state->_delim_ptr = code;
+  state->_delim_ptr = state->_write_ptr++;
+  state->_delim_cnt = 1;
+}
+
+static void CobsEncodeBytes(CobsEncodeState *state, const uint8_t *input_buf, size_t len) {
   for (size_t i = 0; i < len; ++i) {
     // Mandatory delimiter required.
     if (state->_delim_cnt == 0xFF) {
@@ -33,9 +439,119 @@ void CobsEncodeBlock(CobsEncodeState *state, const uint8_t *input_buf, size_t le
 
     input_buf++;
   }
+}
+
+// Copy whole runs of non-delimiter bytes at a time.
+static void CobsEncodeRuns(CobsEncodeState *state, const uint8_t *input_buf, size_t len) {
+  while (len > 0) {
+    // Mandatory delimiter required.
+    if (state->_delim_cnt == 0xFF) {
+      *state->_delim_ptr = state->_delim_cnt;
+      state->_delim_ptr = state->_write_ptr++;
+      state->_delim_cnt = 1;
+    }
+
+    const size_t room = (size_t)(0xFF - state->_delim_cnt);
+    const size_t scan_len = len < room ? len : room;
+    size_t run;
+    if ((uintptr_t)input_buf - (uintptr_t)state->_write_ptr < scan_len) {
+      // Encoding in place.  copy_run may reread input it has already overwritten.
+      run = g_cobs_kernel->find_delim(input_buf, scan_len);
+      memmove(state->_write_ptr, input_buf, run);
+    } else {
+      // Output for the rest of the input lies ahead of _write_ptr, so copy_run may overwrite it.
+      run = g_cobs_kernel->copy_run(state->_write_ptr, input_buf, scan_len);
+    }
+    state->_write_ptr += run;
+    state->_delim_cnt = (uint8_t)(state->_delim_cnt + run);
+    input_buf += run;
+    len -= run;
+
+    // Run ended on a delimiter.
+    if (run < scan_len) {
+      *state->_delim_ptr = state->_delim_cnt;
+      state->_delim_ptr = state->_write_ptr++;
+      state->_delim_cnt = 1;
+      input_buf++;
+      len--;
+    }
+  }
+}
+
+// A group's code is its data length plus one, as with COBS, up to kCobsZpeNoZero for a full group.
+// A zero ending a group short enough to pair is held back until the next byte shows whether it
+// is part of a pair.
+static void CobsEncodeBytesZpe(CobsEncodeState *state, const uint8_t *input_buf, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    const uint8_t byte = input_buf[i];
+
+    if (state->_zero_pending) {
+      state->_zero_pending = false;
+      if (byte == kCobsDelimiter) {
+        CobsEncodeCode(state, (uint8_t)(kCobsZpeNoZero + state->_delim_cnt));
+        continue;
+      }
+      CobsEncodeCode(state, state->_delim_cnt);
+    }
+
+    // Mandatory delimiter required.
+    if (state->_delim_cnt == kCobsZpeNoZero) {
+      CobsEncodeCode(state, kCobsZpeNoZero);
+    }
+
+    if (byte == kCobsDelimiter) {
+      if (state->_delim_cnt <= kCobsZpeMaxPairRun + 1) {
+        state->_zero_pending = true;
+      } else {
+        CobsEncodeCode(state, state->_delim_cnt);
+      }
+    } else {
+      *state->_write_ptr++ = byte;
+      state->_delim_cnt++;
+    }
+  }
+}
+
+static void CobsEncodeData(CobsEncodeState *state, const uint8_t *input_buf, size_t len) {
+  if (state->_mode == kCobsModeZpe) {
+    CobsEncodeBytesZpe(state, input_buf, len);
+  } else if (g_cobs_kernel->find_delim) {
+    CobsEncodeRuns(state, input_buf, len);
+  } else {
+    CobsEncodeBytes(state, input_buf, len);
+  }
+}
+
+void CobsEncodeBlock(CobsEncodeState *state, const uint8_t *input_buf, size_t len, bool finalize) {
+  if (state->_crc.info) {
+    // CRC each chunk just before encoding it, while it is still in cache.
+    while (len > 0) {
+      const size_t chunk = len < kCobsCrcChunk ? len : kCobsCrcChunk;
+      CobsCrcUpdate(&state->_crc, input_buf, chunk);
+      CobsEncodeData(state, input_buf, chunk);
+      input_buf += chunk;
+      len -= chunk;
+    }
+  } else {
+    CobsEncodeData(state, input_buf, len);
+  }
+
+  if (finalize && state->_crc.info) {
+    uint8_t crc[sizeof(uint32_t)];
+    CobsEncodeData(state, crc, CobsCrcFinal(&state->_crc, crc));
+  }
 
   if (finalize) {
-    *state->_delim_ptr = state->_delim_cnt;
+    uint8_t code = state->_delim_cnt;
+    if (state->_mode == kCobsModeReduced && code > 1 && state->_write_ptr[-1] >= code) {
+      // The final data byte replaces the code.  A decoder recognizes it by the frame ending early.
+      code = *--state->_write_ptr;
+    } else if (state->_mode == kCobsModeZpe && state->_zero_pending) {
+      // Pair the last zero with the one implied at the end of the frame.
+      code = (uint8_t)(kCobsZpeNoZero + code);
+      state->_zero_pending = false;
+    }
+    *state->_delim_ptr = code;
     *state->_write_ptr++ = kCobsDelimiter;
     state->len = (size_t)(state->_write_ptr - state->encoded);
   }
@@ -48,8 +564,213 @@ size_t CobsEncodeBuffer(uint8_t *output_buf, const uint8_t *input_buf, size_t in
   return state.len;
 }
 
+size_t CobsEncodeBufferMode(uint8_t *output_buf, const uint8_t *input_buf, size_t input_len,
+                            CobsMode mode) {
+  CobsEncodeState state;
+  CobsEncodeStateInit(&state, output_buf);
+  CobsEncodeStateSetMode(&state, mode);
+  CobsEncodeBlock(&state, input_buf, input_len, true);
+  return state.len;
+}
+
+size_t CobsEncodeInPlace(uint8_t *buf, size_t headroom, size_t len) {
+  // Each code byte replaces a delimiter except for one per full 254 byte run and the leading one,
+  // which the headroom covers, so the output never catches up with the unread input.
+  return CobsEncodeBuffer(buf, buf + headroom, len);
+}
+
+size_t CobsEncodedLen(const uint8_t *input_buf, size_t len) {
+  // A leading code byte and the delimiter, a code byte in place of each delimiter, plus a code byte
+  // splitting each run wherever a 254 byte group is followed by more input.
+  size_t encoded_len = len + 2;
+  while (len > 0) {
+    const size_t run = CobsFindDelim(input_buf, len);
+    if (run < len) {
+      encoded_len += run / 254;
+      input_buf += run + 1;
+      len -= run + 1;
+    } else {
+      encoded_len += (run - 1) / 254;
+      len = 0;
+    }
+  }
+  return encoded_len;
+}
+
+void CobsStreamEncodeStateInit(CobsStreamEncodeState *state, CobsSink sink, void *ctx) {
+  state->_sink = sink;
+  state->_ctx = ctx;
+  state->_delim_cnt = 1;
+  state->_full = false;
+}
+
+static void CobsStreamEncodeFlush(CobsStreamEncodeState *state) {
+  state->_block[0] = state->_delim_cnt;
+  state->_sink(state->_ctx, state->_block, state->_delim_cnt);
+  state->_full = state->_delim_cnt == 0xFF;
+  state->_delim_cnt = 1;
+}
+
+void CobsStreamEncodeBlock(CobsStreamEncodeState *state, const uint8_t *input_buf, size_t len,
+                           bool finalize) {
+  while (len > 0) {
+    // Full groups are flushed straight away, so there is always room for at least one byte.
+    const size_t room = (size_t)(0xFF - state->_delim_cnt);
+    const size_t scan_len = len < room ? len : room;
+    const size_t run = CobsFindDelim(input_buf, scan_len);
+    memcpy(state->_block + state->_delim_cnt, input_buf, run);
+    state->_delim_cnt = (uint8_t)(state->_delim_cnt + run);
+    input_buf += run;
+    len -= run;
+
+    if (run < scan_len) {
+      // Run ended on a delimiter.
+      CobsStreamEncodeFlush(state);
+      input_buf++;
+      len--;
+    } else if (state->_delim_cnt == 0xFF) {
+      CobsStreamEncodeFlush(state);
+    }
+  }
+
+  if (finalize) {
+    if (state->_full && state->_delim_cnt == 1) {
+      // CobsEncodeBlock only starts a new group after a full one once more input follows.
+      state->_sink(state->_ctx, &kCobsDelimiter, 1);
+    } else {
+      // The block holds at most 253 data bytes here, leaving room for the frame delimiter.
+      state->_block[0] = state->_delim_cnt;
+      state->_block[state->_delim_cnt] = kCobsDelimiter;
+      state->_sink(state->_ctx, state->_block, (size_t)state->_delim_cnt + 1);
+    }
+    state->_delim_cnt = 1;
+    state->_full = false;
+  }
+}
+
+#ifdef COBS_IOV
+void CobsEncodeIov(CobsEncodeState *state, const struct iovec *iov, int iovcnt, bool finalize) {
+  for (int i = 0; i < iovcnt; ++i) {
+    CobsEncodeBlock(state, iov[i].iov_base, iov[i].iov_len, false);
+  }
+  if (finalize) {
+    CobsEncodeBlock(state, NULL, 0, true);
+  }
+}
+
+int CobsEncodeToIov(const struct iovec *iov, int iovcnt, uint8_t *scratch, struct iovec *out,
+                    size_t *encoded_len) {
+  struct iovec *out_ptr = out;
+  uint8_t *pending = scratch;  // Scratch bytes not yet referenced by "out".
+  uint8_t *write_ptr = scratch;
+  uint8_t *delim_ptr = write_ptr++;
+  uint8_t delim_cnt = 1;
+  *encoded_len = 0;
+
+  for (int i = 0; i < iovcnt; ++i) {
+    const uint8_t *input_buf = iov[i].iov_base;
+    size_t len = iov[i].iov_len;
+
+    while (len > 0) {
+      // Mandatory delimiter required.
+      if (delim_cnt == 0xFF) {
+        *delim_ptr = delim_cnt;
+        delim_ptr = write_ptr++;
+        delim_cnt = 1;
+      }
+
+      const size_t room = (size_t)(0xFF - delim_cnt);
+      const size_t scan_len = len < room ? len : room;
+      const size_t run = CobsFindDelim(input_buf, scan_len);
+
+      if (run >= COBS_IOV_MIN_RUN) {
+        if (write_ptr > pending) {
+          *out_ptr++ = (struct iovec){pending, (size_t)(write_ptr - pending)};
+        }
+        *out_ptr++ = (struct iovec){(void *)input_buf, run};
+        *encoded_len += (size_t)(write_ptr - pending) + run;
+        pending = write_ptr;
+      } else {
+        memcpy(write_ptr, input_buf, run);
+        write_ptr += run;
+      }
+      delim_cnt = (uint8_t)(delim_cnt + run);
+      input_buf += run;
+      len -= run;
+
+      // Run ended on a delimiter.
+      if (run < scan_len) {
+        *delim_ptr = delim_cnt;
+        delim_ptr = write_ptr++;
+        delim_cnt = 1;
+        input_buf++;
+        len--;
+      }
+    }
+  }
+
+  *delim_ptr = delim_cnt;
+  *write_ptr++ = kCobsDelimiter;
+  *out_ptr++ = (struct iovec){pending, (size_t)(write_ptr - pending)};
+  *encoded_len += (size_t)(write_ptr - pending);
+  return (int)(out_ptr - out);
+}
+#endif
+
+// Decode whole runs at a time.  Matches CobsDecodeByte status semantics.
+static CobsStatus CobsDecodeRuns(uint8_t *output_buf, size_t *output_len, const uint8_t *input_buf,
+                                 size_t input_len) {
+  const uint8_t *const input_end = input_buf + input_len;
+  const size_t capacity = *output_len;
+  size_t len = 0;
+  bool mandatory_delim = true;
+  *output_len = 0;
+
+  while (input_buf < input_end) {
+    const uint8_t code = *input_buf++;
+
+    // End of frame.
+    if (code == kCobsDelimiter) {
+      *output_len = len;
+      return kCobsStatusFrameAvailable;
+    }
+
+    // If there isn't a mandatory delimiter it means the data was the reserved byte.
+    if (!mandatory_delim) {
+      if (len >= capacity) {
+        return kCobsStatusOverflow;
+      }
+      output_buf[len++] = kCobsDelimiter;
+    }
+    mandatory_delim = code == 0xFF;
+
+    const size_t remaining = (size_t)(input_end - input_buf);
+    const size_t scan_len = (size_t)(code - 1) < remaining ? (size_t)(code - 1) : remaining;
+    const size_t run = g_cobs_kernel->find_delim(input_buf, scan_len);
+
+    if (capacity - len < run) {
+      return kCobsStatusOverflow;
+    }
+    // Output may alias the input behind it for in place decoding.
+    memmove(output_buf + len, input_buf, run);
+    len += run;
+    input_buf += run;
+
+    // Delimiter within run.
+    if (run < scan_len) {
+      return kCobsStatusMalformedFrame;
+    }
+  }
+
+  return kCobsStatusIncompleteFrame;
+}
+
 CobsStatus CobsDecodeBuffer(uint8_t *output_buf, size_t *output_len, const uint8_t *input_buf,
                             size_t input_len) {
+  if (g_cobs_kernel->find_delim) {
+    return CobsDecodeRuns(output_buf, output_len, input_buf, input_len);
+  }
+
   CobsDecodeState state;
   CobsDecodeStateInit(&state, output_buf, *output_len);
   *output_len = 0;
@@ -75,24 +796,159 @@ static inline void CobsDecodeStateReset(CobsDecodeState *state) {
   state->_write_ptr = state->decoded;
   state->_delim_cnt = 0;
   state->_mandatory_delim = true;
+  state->_code = 0;
+  if (state->_crc.info) {
+    CobsCrcInit(&state->_crc, state->_crc.info, state->_crc.bits);
+  }
 }
 
 void CobsDecodeStateInit(CobsDecodeState *state, uint8_t *output_buf, size_t len) {
   state->decoded = output_buf;
   state->len = 0;
   state->_end_ptr = output_buf + len;
+  CobsCrcInit(&state->_crc, NULL, 0);
+  state->_mode = kCobsModeStandard;
 
   CobsDecodeStateReset(state);
 }
 
+void CobsDecodeStateInitCrc8(CobsDecodeState *state, uint8_t *output_buf, size_t len,
+                             const Crc8Info *info) {
+  CobsDecodeStateInit(state, output_buf, len);
+  CobsCrcInit(&state->_crc, info, 8);
+}
+
+void CobsDecodeStateInitCrc16(CobsDecodeState *state, uint8_t *output_buf, size_t len,
+                              const Crc16Info *info) {
+  CobsDecodeStateInit(state, output_buf, len);
+  CobsCrcInit(&state->_crc, info, 16);
+}
+
+void CobsDecodeStateInitCrc32(CobsDecodeState *state, uint8_t *output_buf, size_t len,
+                              const Crc32Info *info) {
+  CobsDecodeStateInit(state, output_buf, len);
+  CobsCrcInit(&state->_crc, info, 32);
+}
+
+// Check and strip the CRC of a complete frame of "len" bytes.  Returns the frame status.
+static CobsStatus CobsDecodeCrcFrame(CobsDecodeState *state, size_t len) {
+  if (!state->_crc.info) {
+    state->len = len;
+    return kCobsStatusFrameAvailable;
+  }
+
+  const size_t crc_len = state->_crc.bits / 8;
+  if (len < crc_len || !CobsCrcCheck(&state->_crc)) {
+    return kCobsStatusCrcError;
+  }
+  state->len = len - crc_len;
+  return kCobsStatusFrameAvailable;
+}
+
+void CobsDecodeStateSetMode(CobsDecodeState *state, CobsMode mode) {
+  state->_mode = mode;
+  CobsDecodeStateReset(state);
+}
+
+// Number of data bytes following "code".
+static inline uint8_t CobsGroupLen(CobsMode mode, uint8_t code) {
+  if (mode == kCobsModeZpe && code > kCobsZpeNoZero) {
+    return (uint8_t)(code - kCobsZpeNoZero - 1);
+  }
+  return (uint8_t)(code - 1);
+}
+
+// Number of zeros following the data of the group with "code", once another group follows.
+static inline size_t CobsGroupZeros(CobsMode mode, uint8_t code) {
+  if (code == 0) {
+    return 0;
+  }
+  if (mode == kCobsModeZpe) {
+    return code < kCobsZpeNoZero ? 1 : code == kCobsZpeNoZero ? 0 : 2;
+  }
+  return code == 0xFF ? 0 : 1;
+}
+
+// Append "byte" to the decoded frame.  Returns false if it doesn't fit.
+static inline bool CobsDecodePut(CobsDecodeState *state, uint8_t byte) {
+  if (state->_write_ptr >= state->_end_ptr) {
+    return false;
+  }
+  *state->_write_ptr++ = byte;
+  if (state->_crc.info) {
+    CobsCrcUpdateByte(&state->_crc, byte);
+  }
+  return true;
+}
+
+// Append "count" zeros to the decoded frame.  Returns false if they don't fit.
+static bool CobsDecodePutZeros(CobsDecodeState *state, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (!CobsDecodePut(state, kCobsDelimiter)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// CobsDecodeByte for COBS/R and COBS/ZPE.
+static CobsStatus CobsDecodeByteVariant(CobsDecodeState *state, uint8_t byte) {
+  CobsStatus status = kCobsStatusProcessing;
+
+  if (byte == kCobsDelimiter) {
+    if (state->_delim_cnt == 0) {
+      // The last group's zeros end with the one implied at the end of the frame.
+      const size_t zeros = CobsGroupZeros(state->_mode, state->_code);
+      if (zeros > 1 && !CobsDecodePutZeros(state, zeros - 1)) {
+        status = kCobsStatusOverflow;
+      }
+    } else if (state->_mode == kCobsModeReduced) {
+      // Frame ended early, so the code byte was the final data byte.
+      if (!CobsDecodePut(state, state->_code)) {
+        status = kCobsStatusOverflow;
+      }
+    } else {
+      status = kCobsStatusMalformedFrame;
+    }
+    if (status == kCobsStatusProcessing) {
+      status = CobsDecodeCrcFrame(state, (size_t)(state->_write_ptr - state->decoded));
+    }
+    CobsDecodeStateReset(state);
+    return status;
+  }
+
+  if (state->_delim_cnt == 0) {
+    // Code byte.  The previous group's zeros follow its data.
+    if (!CobsDecodePutZeros(state, CobsGroupZeros(state->_mode, state->_code))) {
+      CobsDecodeStateReset(state);
+      return kCobsStatusOverflow;
+    }
+    state->_code = byte;
+    state->_delim_cnt = CobsGroupLen(state->_mode, byte);
+    return kCobsStatusProcessing;
+  }
+
+  if (!CobsDecodePut(state, byte)) {
+    CobsDecodeStateReset(state);
+    return kCobsStatusOverflow;
+  }
+  state->_delim_cnt--;
+  return kCobsStatusProcessing;
+}
+
 CobsStatus CobsDecodeByte(CobsDecodeState *state, uint8_t byte) {
+  if (state->_mode != kCobsModeStandard) {
+    return CobsDecodeByteVariant(state, byte);
+  }
+
   // This byte is a delimiter.
   if (state->_delim_cnt == 0) {
     // End of frame.
     if (byte == kCobsDelimiter) {
-      state->len = (size_t)(state->_write_ptr - state->decoded);
+      const CobsStatus status =
+          CobsDecodeCrcFrame(state, (size_t)(state->_write_ptr - state->decoded));
       CobsDecodeStateReset(state);
-      return kCobsStatusFrameAvailable;
+      return status;
     }
 
     // If there isn't a mandatory delimiter it means the data was the reserved byte.
@@ -102,6 +958,9 @@ CobsStatus CobsDecodeByte(CobsDecodeState *state, uint8_t byte) {
         return kCobsStatusOverflow;
       }
       *state->_write_ptr++ = kCobsDelimiter;
+      if (state->_crc.info) {
+        CobsCrcUpdateByte(&state->_crc, kCobsDelimiter);
+      }
     }
 
     state->_delim_cnt = byte;
@@ -120,9 +979,150 @@ CobsStatus CobsDecodeByte(CobsDecodeState *state, uint8_t byte) {
     }
 
     *state->_write_ptr++ = byte;
+    if (state->_crc.info) {
+      CobsCrcUpdateByte(&state->_crc, byte);
+    }
   }
 
   state->_delim_cnt--;
 
   return kCobsStatusProcessing;
 }
+
+size_t CobsFindDelimiter(const uint8_t *input_buf, size_t len) {
+  return CobsFindDelim(input_buf, len);
+}
+
+CobsStatus CobsDecodeBlock(CobsDecodeState *state, const uint8_t *input_buf, size_t len,
+                           size_t *consumed) {
+  const uint8_t *const input_start = input_buf;
+  const uint8_t *const input_end = input_buf + len;
+  CobsStatus status = kCobsStatusProcessing;
+
+  while (input_buf < input_end) {
+    // Code bytes follow CobsDecodeByte exactly.
+    if (state->_delim_cnt == 0) {
+      status = CobsDecodeByte(state, *input_buf++);
+      if (status != kCobsStatusProcessing) {
+        break;
+      }
+      continue;
+    }
+
+    const size_t remaining = (size_t)(input_end - input_buf);
+    const size_t scan_len = state->_delim_cnt < remaining ? state->_delim_cnt : remaining;
+    const size_t room = (size_t)(state->_end_ptr - state->_write_ptr);
+    const size_t run = CobsFindDelim(input_buf, scan_len);
+
+    // Byte at index "room" is the first that doesn't fit.
+    if (run > room) {
+      input_buf += room + 1;
+      status = kCobsStatusOverflow;
+      CobsDecodeStateReset(state);
+      break;
+    }
+
+    // Output may alias the input behind it for in place decoding.
+    memmove(state->_write_ptr, input_buf, run);
+    if (state->_crc.info) {
+      CobsCrcUpdate(&state->_crc, input_buf, run);
+    }
+    state->_write_ptr += run;
+    state->_delim_cnt = (uint8_t)(state->_delim_cnt - run);
+    input_buf += run;
+
+    // Delimiter within run.  Malformed, except that it ends a COBS/R frame.
+    if (run < scan_len) {
+      status = CobsDecodeByte(state, *input_buf++);
+      break;
+    }
+  }
+
+  *consumed = (size_t)(input_buf - input_start);
+  return status;
+}
+
+CobsStatus CobsDecodeBufferMode(uint8_t *output_buf, size_t *output_len, const uint8_t *input_buf,
+                                size_t input_len, CobsMode mode) {
+  if (mode == kCobsModeStandard) {
+    return CobsDecodeBuffer(output_buf, output_len, input_buf, input_len);
+  }
+
+  CobsDecodeState state;
+  CobsDecodeStateInit(&state, output_buf, *output_len);
+  CobsDecodeStateSetMode(&state, mode);
+  *output_len = 0;
+
+  size_t consumed;
+  const CobsStatus status = CobsDecodeBlock(&state, input_buf, input_len, &consumed);
+  if (status == kCobsStatusFrameAvailable) {
+    *output_len = state.len;
+  }
+  return status == kCobsStatusProcessing ? kCobsStatusIncompleteFrame : status;
+}
+
+CobsStatus CobsDecodeInPlace(uint8_t *buf, size_t len, size_t *output_len) {
+  // Decoded data never runs ahead of the encoded data it came from.
+  *output_len = len;
+  return CobsDecodeBuffer(buf, output_len, buf, len);
+}
+
+void CobsDecodeInPlaceStateInit(CobsDecodeInPlaceState *state, uint8_t *buf, size_t size) {
+  state->buf = buf;
+  state->size = size;
+  state->_read_ptr = buf;
+  state->_end_ptr = buf;
+  CobsDecodeStateInit(&state->_decode, buf, size);
+}
+
+// Start a new frame at the next unread byte.
+static void CobsDecodeInPlaceStartFrame(CobsDecodeInPlaceState *state) {
+  state->_decode.decoded = state->_read_ptr;
+  CobsDecodeStateReset(&state->_decode);
+}
+
+uint8_t *CobsDecodeInPlaceWritePtr(CobsDecodeInPlaceState *state, size_t *available) {
+  // Move the frame in progress, decoded and undecoded parts alike, to the front of the buffer.
+  const size_t shift = (size_t)(state->_decode.decoded - state->buf);
+  if (shift) {
+    memmove(state->buf, state->_decode.decoded, (size_t)(state->_end_ptr - state->_decode.decoded));
+    state->_decode.decoded -= shift;
+    state->_decode._write_ptr -= shift;
+    state->_read_ptr -= shift;
+    state->_end_ptr -= shift;
+  }
+
+  *available = (size_t)(state->buf + state->size - state->_end_ptr);
+  return state->_end_ptr;
+}
+
+void CobsDecodeInPlaceCommit(CobsDecodeInPlaceState *state, size_t len) { state->_end_ptr += len; }
+
+CobsStatus CobsDecodeInPlaceNext(CobsDecodeInPlaceState *state, uint8_t **frame, size_t *len) {
+  *frame = NULL;
+  *len = 0;
+
+  size_t consumed;
+  const CobsStatus status =
+      CobsDecodeBlock(&state->_decode, state->_read_ptr,
+                      (size_t)(state->_end_ptr - state->_read_ptr), &consumed);
+  state->_read_ptr += consumed;
+
+  if (status == kCobsStatusProcessing) {
+    // Frame fills the whole buffer without ending.
+    if (state->_decode.decoded == state->buf && state->_end_ptr == state->buf + state->size) {
+      state->_read_ptr = state->buf;
+      state->_end_ptr = state->buf;
+      CobsDecodeInPlaceStartFrame(state);
+      return kCobsStatusOverflow;
+    }
+    return status;
+  }
+
+  if (status == kCobsStatusFrameAvailable) {
+    *frame = state->_decode.decoded;
+    *len = state->_decode.len;
+  }
+  CobsDecodeInPlaceStartFrame(state);
+  return status;
+}
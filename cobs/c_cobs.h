@@ -4,13 +4,45 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "crc/c_crc.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+
+// Scatter-gather encoding with struct iovec is available.
+#define COBS_IOV 1
+
+// Shortest run CobsEncodeToIov references in place rather than copying into its scratch buffer.
+#define COBS_IOV_MIN_RUN 64
+
+// Maximum number of iovecs output by CobsEncodeToIov for a frame of decode_len bytes.
+#define COBS_MAX_IOV_OUT(decode_len) (2 * ((decode_len) / COBS_IOV_MIN_RUN) + 1)
+#endif
+
 // Calculate maximum COBS encoded length from decoded length.
 #define COBS_MAX_ENCODE_LEN(decode_len) \
   ((decode_len) > 0 ? (decode_len) + ((decode_len) + 253) / 254 + 1 : 2)
 
+// Calculate headroom needed in front of a payload of length decode_len to encode it in place.
+#define COBS_ENCODE_HEADROOM(decode_len) (COBS_MAX_ENCODE_LEN(decode_len) - (decode_len))
+
 // Calculate maximum COBS decoded length from encoded length.
 #define COBS_MAX_DECODE_LEN(encode_len) ((encode_len) > 1 ? (encode_len)-2 : 0)
 
+// Calculate maximum COBS/R encoded length from decoded length.  Never longer than COBS.
+#define COBS_R_MAX_ENCODE_LEN(decode_len) COBS_MAX_ENCODE_LEN(decode_len)
+
+// Calculate maximum COBS/R decoded length from encoded length.
+#define COBS_R_MAX_DECODE_LEN(encode_len) ((encode_len) > 1 ? (encode_len)-1 : 0)
+
+// Calculate maximum COBS/ZPE encoded length from decoded length.
+#define COBS_ZPE_MAX_ENCODE_LEN(decode_len) \
+  ((decode_len) > 0 ? (decode_len) + ((decode_len) + 222) / 223 + 1 : 2)
+
+// Calculate maximum COBS/ZPE decoded length from encoded length.  Zero pairs decode to more bytes
+// than they were encoded as.
+#define COBS_ZPE_MAX_DECODE_LEN(encode_len) ((encode_len) > 1 ? 2 * ((encode_len)-1) - 1 : 0)
+
 typedef enum {
   kCobsStatusForceSigned = -1,
   kCobsStatusProcessing,
@@ -18,9 +50,38 @@ typedef enum {
   kCobsStatusMalformedFrame,
   kCobsStatusOverflow,
   kCobsStatusIncompleteFrame,
+  kCobsStatusCrcError,
   kNumCobsStatus
 } CobsStatus;
 
+typedef enum {
+  kCobsModeForceSigned = -1,
+  kCobsModeStandard,  // COBS.
+  // COBS/R.  The final code byte is replaced by the final data byte when that is not smaller,
+  // saving a byte on most frames.
+  kCobsModeReduced,
+  // COBS/ZPE.  Code bytes 0xE1 to 0xFF stand for up to 30 data bytes followed by a pair of zeros,
+  // halving runs of zeros.  Runs without zeros are split every 223 bytes.
+  kCobsModeZpe,
+  kNumCobsMode
+} CobsMode;
+
+typedef enum {
+  kCobsKernelForceSigned = -1,
+  kCobsKernelScalar,  // Byte at a time.
+  kCobsKernelSwar,  // Word at a time delimiter search with whole run copies.
+  kCobsKernelSse2,  // 16 byte vector delimiter search with whole run copies.
+  kCobsKernelAvx2,  // 32 byte vector delimiter search with whole run copies.
+  kNumCobsKernel
+} CobsKernel;
+
+// Running CRC for the fused CRC modes.  Private.
+typedef struct {
+  const void *info;  // Crc8Info, Crc16Info, or Crc32Info.  NULL if unused.
+  uint32_t crc;
+  uint8_t bits;
+} CobsCrc;
+
 typedef struct {
   // Public.
   uint8_t *encoded;  // Encoded output buffer.
@@ -30,6 +91,9 @@ typedef struct {
   uint8_t *_delim_ptr;
   uint8_t *_write_ptr;
   uint8_t _delim_cnt;
+  CobsCrc _crc;
+  CobsMode _mode;
+  bool _zero_pending;  // COBS/ZPE.  Zero ending the current group may form a pair.
 } CobsEncodeState;
 
 typedef struct {
@@ -42,11 +106,51 @@ typedef struct {
   uint8_t *_end_ptr;
   uint8_t _delim_cnt;
   bool _mandatory_delim;
+  CobsCrc _crc;
+  CobsMode _mode;
+  uint8_t _code;  // Code byte of the current group for COBS/R and COBS/ZPE, 0 before the first.
 } CobsDecodeState;
 
+// Receives encoded output from CobsStreamEncodeBlock.
+typedef void (*CobsSink)(void *ctx, const uint8_t *data, size_t len);
+
+typedef struct {
+  // Private.
+  CobsSink _sink;
+  void *_ctx;
+  uint8_t _block[255];  // Code byte followed by the data bytes of the group in progress.
+  uint8_t _delim_cnt;
+  bool _full;  // Last group flushed was a full 254 data bytes.
+} CobsStreamEncodeState;
+
+typedef struct {
+  // Public.
+  uint8_t *buf;  // Receive buffer, decoded in place.
+  size_t size;  // Size of receive buffer.
+
+  // Private.
+  CobsDecodeState _decode;
+  uint8_t *_read_ptr;
+  uint8_t *_end_ptr;
+} CobsDecodeInPlaceState;
+
 // Initialize state for use with CobsEncodeBlock.
 void CobsEncodeStateInit(CobsEncodeState *state, uint8_t *output_buf);
 
+// Initialize state for use with CobsEncodeBlock, additionally computing the CRC of the input as it
+// is encoded and appending it to the frame on finalize.  The CRC is appended least significant
+// byte first for lsb_first CRCs and most significant byte first otherwise, so a Crc*Block over
+// the decoded frame yields the CRC's constant residue.  The output buffer must hold
+// COBS_MAX_ENCODE_LEN(input_len + CRC bytes).
+void CobsEncodeStateInitCrc8(CobsEncodeState *state, uint8_t *output_buf, const Crc8Info *info);
+void CobsEncodeStateInitCrc16(CobsEncodeState *state, uint8_t *output_buf, const Crc16Info *info);
+void CobsEncodeStateInitCrc32(CobsEncodeState *state, uint8_t *output_buf, const Crc32Info *info);
+
+// Select the encoding variant, after any CobsEncodeStateInit*.  Defaults to kCobsModeStandard.
+// The output buffer must hold the variant's maximum encoded length, e.g. COBS_ZPE_MAX_ENCODE_LEN.
+// COBS/ZPE is encoded a byte at a time.
+void CobsEncodeStateSetMode(CobsEncodeState *state, CobsMode mode);
+
 // Sequentially encode block of data into output buffer specified by "state".  Optionally finalizing
 // encoded data via "finalize".
 void CobsEncodeBlock(CobsEncodeState *state, const uint8_t *input_buf, size_t len, bool finalize);
@@ -54,14 +158,121 @@ void CobsEncodeBlock(CobsEncodeState *state, const uint8_t *input_buf, size_t le
 // Encode single input buffer into output buffer.  Store encoded length in "output_len".
 size_t CobsEncodeBuffer(uint8_t *output_buf, const uint8_t *input_buf, size_t input_len);
 
+// Encode single input buffer into output buffer using "mode".  Returns encoded length.
+size_t CobsEncodeBufferMode(uint8_t *output_buf, const uint8_t *input_buf, size_t input_len,
+                            CobsMode mode);
+
+// Encode the "len" byte payload located "headroom" bytes into "buf" over itself, with the encoded
+// frame starting at "buf".  "headroom" must be at least COBS_ENCODE_HEADROOM(len).  Returns the
+// encoded length.  CobsEncodeBlock also accepts input located this way within its output buffer.
+size_t CobsEncodeInPlace(uint8_t *buf, size_t headroom, size_t len);
+
+// Exact length CobsEncodeBuffer would encode "input_buf" to, including the frame delimiter.  Counts
+// runs of non-delimiter bytes with the selected kernel's vector search, without writing output.
+size_t CobsEncodedLen(const uint8_t *input_buf, size_t len);
+
+// Initialize state for cut-through encoding to "sink", which is called with "ctx" as each group of
+// the frame is completed rather than once the frame is finished.
+void CobsStreamEncodeStateInit(CobsStreamEncodeState *state, CobsSink sink, void *ctx);
+
+// Sequentially encode block of data as with CobsEncodeBlock, passing each group to the sink once
+// its code byte is known: at a delimiter or after 254 data bytes.  On finalize, passes the last
+// group and frame delimiter and starts a new frame.  Output is identical to CobsEncodeBlock.
+void CobsStreamEncodeBlock(CobsStreamEncodeState *state, const uint8_t *input_buf, size_t len,
+                           bool finalize);
+
+#ifdef COBS_IOV
+// Sequentially encode the "iovcnt" segments of "iov" as with CobsEncodeBlock.
+void CobsEncodeIov(CobsEncodeState *state, const struct iovec *iov, int iovcnt, bool finalize);
+
+// Encode the frame made of the "iovcnt" segments of "iov" as a list of iovecs for writev(), without
+// copying runs of COBS_IOV_MIN_RUN or more non-delimiter bytes out of the segments.  Code bytes and
+// shorter runs are written to "scratch", which must hold COBS_MAX_ENCODE_LEN(frame length) bytes.
+// "out" must hold COBS_MAX_IOV_OUT(frame length) iovecs.  Returns the number of iovecs written to
+// "out", storing their total length in "encoded_len".
+int CobsEncodeToIov(const struct iovec *iov, int iovcnt, uint8_t *scratch, struct iovec *out,
+                    size_t *encoded_len);
+#endif
+
 // Initialize state for use with CobsDecodeByte.
 void CobsDecodeStateInit(CobsDecodeState *state, uint8_t *output_buf, size_t len);
 
+// Initialize state for use with CobsDecodeByte, additionally verifying the CRC appended to each
+// frame (see CobsEncodeStateInitCrc*) while decoding.  Frames failing the check are reported as
+// kCobsStatusCrcError.  The reported frame length excludes the CRC, which still requires room in
+// the output buffer.
+void CobsDecodeStateInitCrc8(CobsDecodeState *state, uint8_t *output_buf, size_t len,
+                             const Crc8Info *info);
+void CobsDecodeStateInitCrc16(CobsDecodeState *state, uint8_t *output_buf, size_t len,
+                              const Crc16Info *info);
+void CobsDecodeStateInitCrc32(CobsDecodeState *state, uint8_t *output_buf, size_t len,
+                              const Crc32Info *info);
+
+// Select the encoding variant, after any CobsDecodeStateInit*.  Defaults to kCobsModeStandard.
+void CobsDecodeStateSetMode(CobsDecodeState *state, CobsMode mode);
+
 // Sequentially decode data per byte into buffer associated with "state".  Resets decoder on success
 // or COBS error.  Returns decode status.
 CobsStatus CobsDecodeByte(CobsDecodeState *state, uint8_t byte);
 
+// Sequentially decode a block of data into buffer associated with "state", copying whole runs at a
+// time.  Stops after the first frame delimiter or error, storing the number of bytes of "input_buf"
+// used in "consumed" so the caller can handle the frame and resume with the remainder.  Returns
+// kCobsStatusProcessing if all of "input_buf" was consumed mid frame, otherwise the status
+// CobsDecodeByte would have returned for the last consumed byte.  Resets decoder on success or
+// COBS error.
+CobsStatus CobsDecodeBlock(CobsDecodeState *state, const uint8_t *input_buf, size_t len,
+                           size_t *consumed);
+
 // Decodes single input buffer into output buffer, writing "output_len" on success. Returns decode
 // status.
 CobsStatus CobsDecodeBuffer(uint8_t *output_buf, size_t *output_len, const uint8_t *input_buf,
                             size_t input_len);
+
+// Decodes single input buffer encoded using "mode" into output buffer, writing "output_len" on
+// success.  Returns decode status.
+CobsStatus CobsDecodeBufferMode(uint8_t *output_buf, size_t *output_len, const uint8_t *input_buf,
+                                size_t input_len, CobsMode mode);
+
+// Decodes the frame at the start of "buf" over the encoded data, writing "output_len" on success.
+// Returns decode status.  CobsDecodeBuffer also accepts output_buf == input_buf.
+CobsStatus CobsDecodeInPlace(uint8_t *buf, size_t len, size_t *output_len);
+
+// Initialize state for streaming in place decoding of data received into "buf".
+void CobsDecodeInPlaceStateInit(CobsDecodeInPlaceState *state, uint8_t *buf, size_t size);
+
+// Where to receive the next data into, storing the free space in "available".  Moves any frame in
+// progress to the front of the buffer, which invalidates frames returned by CobsDecodeInPlaceNext.
+uint8_t *CobsDecodeInPlaceWritePtr(CobsDecodeInPlaceState *state, size_t *available);
+
+// Mark "len" bytes received at CobsDecodeInPlaceWritePtr.
+void CobsDecodeInPlaceCommit(CobsDecodeInPlaceState *state, size_t len);
+
+// Decode received data up to the next frame delimiter or error.  On kCobsStatusFrameAvailable
+// "frame" and "len" point at the decoded frame within the receive buffer, valid until the next
+// CobsDecodeInPlaceWritePtr.  Returns kCobsStatusProcessing once all received data is consumed,
+// or kCobsStatusOverflow (dropping the data) if a frame fills the whole buffer.  Call repeatedly
+// until it returns kCobsStatusProcessing.
+CobsStatus CobsDecodeInPlaceNext(CobsDecodeInPlaceState *state, uint8_t **frame, size_t *len);
+
+// Index of the first frame delimiter in "input_buf", or "len" if there is none.  Uses the
+// selected kernel's vector search.
+size_t CobsFindDelimiter(const uint8_t *input_buf, size_t len);
+
+// Kernel used by CobsEncodeBlock and CobsDecodeBuffer.  Defaults to the fastest kernel the CPU
+// supports, detected once at load time.
+CobsKernel CobsGetKernel(void);
+
+// Human readable kernel name for logging.
+const char *CobsKernelName(CobsKernel kernel);
+
+// Whether "kernel" can run on this CPU.
+bool CobsKernelSupported(CobsKernel kernel);
+
+// Select "kernel".  Returns false and keeps the current kernel if it is unsupported.  Not safe to
+// call concurrently with encoding or decoding; intended for startup.
+bool CobsSetKernel(CobsKernel kernel);
+
+// Time each supported kernel and select the fastest.  Returns the selected kernel.  Not safe to
+// call concurrently with encoding or decoding; intended for startup.
+CobsKernel CobsAutotune(void);
@@ -0,0 +1,134 @@
+// Indexes a raw capture of back to back COBS frames and decodes frames from it by number or byte
+// range.  The index is kept in CAPTURE.idx and rebuilt when the capture changes.
+//
+// Usage: capture_index [--crc NAME] [--frame N]... [--range BEGIN END]... CAPTURE
+//
+// --crc records each frame's CRC status using a CRC from crc/all_crcs.h, named as in py_crc, e.g.
+// kCrc16KermitInfo.
+// --frame prints frame N as hex.  --range prints the frames starting within [BEGIN, END).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cobs/cc_capture.h"
+
+extern "C" {
+#include "crc/all_crcs.h"
+}
+
+namespace {
+
+struct CrcOption {
+  const char *name;
+  int bits;
+  const void *info;
+};
+
+#define CRC_OPTION(bits, name) {#name "Info", bits, &name##Info},
+const CrcOption kCrcs[] = {ALL_CRCS(CRC_OPTION)};
+#undef CRC_OPTION
+
+template <int N>
+void IndexWithCrc(cobs::Capture &capture, const void *info, const std::string &index_path) {
+  const auto *crc_info = static_cast<const typename crc::Crc<N>::Info *>(info);
+  if (!capture.LoadIndex(index_path) || !capture.HasCrcStatus<N>(crc_info)) {
+    capture.BuildIndex<N>(crc_info);
+    capture.SaveIndex(index_path);
+  }
+}
+
+void PrintFrame(const cobs::Capture &capture, size_t n, bool crc) {
+  const auto [status, decoded] = capture.Decode(n);
+  std::printf("frame %zu offset %zu len %zu %s", n, capture.Offset(n), capture.Encoded(n).second,
+              cobs::StatusName(status));
+  if (crc) {
+    std::printf(" crc %s", cobs::StatusName(capture.CrcStatus(n)));
+  }
+  std::printf(":");
+  for (uint8_t byte : decoded) {
+    std::printf(" %02x", byte);
+  }
+  std::printf("\n");
+}
+
+int Usage(const char *argv0) {
+  std::fprintf(stderr, "Usage: %s [--crc NAME] [--frame N]... [--range BEGIN END]... CAPTURE\n",
+               argv0);
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const CrcOption *crc = nullptr;
+  std::vector<size_t> frames;
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  const char *path = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--crc") == 0 && i + 1 < argc) {
+      ++i;
+      for (const auto &option : kCrcs) {
+        if (std::strcmp(argv[i], option.name) == 0) {
+          crc = &option;
+        }
+      }
+      if (!crc) {
+        std::fprintf(stderr, "Unknown CRC: %s\n", argv[i]);
+        return 2;
+      }
+    } else if (std::strcmp(argv[i], "--frame") == 0 && i + 1 < argc) {
+      frames.push_back(std::strtoull(argv[++i], nullptr, 0));
+    } else if (std::strcmp(argv[i], "--range") == 0 && i + 2 < argc) {
+      const uint64_t begin = std::strtoull(argv[++i], nullptr, 0);
+      const uint64_t end = std::strtoull(argv[++i], nullptr, 0);
+      ranges.push_back({begin, end});
+    } else if (!path && argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      return Usage(argv[0]);
+    }
+  }
+  if (!path) {
+    return Usage(argv[0]);
+  }
+
+  cobs::Capture capture;
+  if (!capture.Open(path)) {
+    std::perror(path);
+    return 1;
+  }
+
+  const std::string index_path = std::string(path) + ".idx";
+  if (!crc) {
+    if (!capture.LoadIndex(index_path)) {
+      capture.BuildIndex();
+      capture.SaveIndex(index_path);
+    }
+  } else if (crc->bits == 8) {
+    IndexWithCrc<8>(capture, crc->info, index_path);
+  } else if (crc->bits == 16) {
+    IndexWithCrc<16>(capture, crc->info, index_path);
+  } else {
+    IndexWithCrc<32>(capture, crc->info, index_path);
+  }
+  std::fprintf(stderr, "%zu bytes, %zu frames\n", capture.Size(), capture.NumFrames());
+
+  for (size_t n : frames) {
+    if (n >= capture.NumFrames()) {
+      std::fprintf(stderr, "No frame %zu\n", n);
+      return 1;
+    }
+    PrintFrame(capture, n, crc != nullptr);
+  }
+  for (const auto &[begin, end] : ranges) {
+    const auto [first, last] = capture.FramesInRange(begin, end);
+    for (size_t n = first; n < last; ++n) {
+      PrintFrame(capture, n, crc != nullptr);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cobs/cc_cobs.h"
+#include "crc/cc_crc.h"
+
+namespace cobs {
+
+// Read only memory mapped capture of back to back COBS frames with an index of frame boundaries,
+// giving constant time access to any frame.  The index can be saved to and loaded from a sidecar
+// file so it is only built once per capture.
+class Capture {
+ public:
+  Capture() = default;
+
+  Capture(const Capture &) = delete;
+  Capture &operator=(const Capture &) = delete;
+
+  ~Capture() { Close(); }
+
+  // Map the capture at "path".  Returns false on failure.
+  bool Open(const std::string &path) {
+    Close();
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0;
+    if (ok && st.st_size > 0) {
+      void *map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      ok = map != MAP_FAILED;
+      if (ok) {
+        data_ = static_cast<const uint8_t *>(map);
+        size_ = static_cast<size_t>(st.st_size);
+      }
+    }
+    if (ok) {
+      mtime_ns_ = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+    close(fd);
+    return ok;
+  }
+
+  void Close() {
+    if (data_) {
+      munmap(const_cast<uint8_t *>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    mtime_ns_ = 0;
+    offsets_.clear();
+    crc_status_.clear();
+    crc_bits_ = 0;
+    crc_check_ = 0;
+  }
+
+  const uint8_t *Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+  // Index frame boundaries with a single delimiter scan.  Trailing bytes without a delimiter form
+  // a final incomplete frame.
+  void BuildIndex() {
+    offsets_.clear();
+    crc_status_.clear();
+    crc_bits_ = 0;
+    crc_check_ = 0;
+
+    offsets_.push_back(0);
+    size_t pos = 0;
+    while (pos < size_) {
+      pos += CobsFindDelimiter(data_ + pos, size_ - pos);
+      pos = std::min(pos + 1, size_);
+      offsets_.push_back(pos);
+    }
+  }
+
+  // Index frame boundaries and record whether each frame passes the CRC appended by CrcEncoder.
+  template <int N>
+  void BuildIndex(const typename crc::Crc<N>::Info *info) {
+    BuildIndex();
+    crc_bits_ = N;
+    crc_check_ = CrcCheck<N>(info);
+    crc_status_.resize(NumFrames());
+
+    size_t max_len = 0;
+    for (size_t n = 0; n < NumFrames(); ++n) {
+      max_len = std::max(max_len, offsets_[n + 1] - offsets_[n]);
+    }
+    CrcDecoder<N> decoder(info, max_len);
+    for (size_t n = 0; n < NumFrames(); ++n) {
+      decoder.Reset();
+      const auto [frame, len] = Encoded(n);
+      size_t consumed;
+      Status status = decoder.Decode(frame, len, &consumed).first;
+      crc_status_[n] = static_cast<uint8_t>(status == Status::Processing ? Status::IncompleteFrame
+                                                                         : status);
+    }
+  }
+
+  // Save the index to "path".  Returns false on failure.
+  bool SaveIndex(const std::string &path) const {
+    const IndexHeader header = MakeHeader();
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+      return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(offsets_.data(), sizeof(uint64_t), offsets_.size(), file) ==
+                  offsets_.size() &&
+              std::fwrite(crc_status_.data(), 1, crc_status_.size(), file) == crc_status_.size();
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+  }
+
+  // Load an index saved by SaveIndex.  Returns false if it is missing, corrupt, or was built for a
+  // different version of the capture.
+  bool LoadIndex(const std::string &path) {
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+      return false;
+    }
+    IndexHeader header;
+    const IndexHeader expected = MakeHeader();
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0 &&
+              header.version == expected.version && header.capture_size == size_ &&
+              header.capture_mtime_ns == mtime_ns_ && header.num_frames <= size_;
+    if (ok) {
+      offsets_.resize(header.num_frames + 1);
+      crc_status_.resize(header.crc_bits ? header.num_frames : 0);
+      ok = std::fread(offsets_.data(), sizeof(uint64_t), offsets_.size(), file) ==
+               offsets_.size() &&
+           std::fread(crc_status_.data(), 1, crc_status_.size(), file) == crc_status_.size() &&
+           offsets_.front() == 0 && offsets_.back() == size_ &&
+           std::is_sorted(offsets_.begin(), offsets_.end());
+      crc_bits_ = header.crc_bits;
+      crc_check_ = header.crc_check;
+    }
+    std::fclose(file);
+    if (!ok) {
+      offsets_.clear();
+      crc_status_.clear();
+      crc_bits_ = 0;
+      crc_check_ = 0;
+    }
+    return ok;
+  }
+
+  size_t NumFrames() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+
+  // Encoded frame "n", including its delimiter.
+  std::pair<const uint8_t *, size_t> Encoded(size_t n) const {
+    return {data_ + offsets_[n], offsets_[n + 1] - offsets_[n]};
+  }
+
+  size_t Offset(size_t n) const { return offsets_[n]; }
+
+  // Decode frame "n" into "output_buf", which must hold Encoded(n).second bytes.
+  Status Decode(size_t n, uint8_t *output_buf, size_t *output_len) const {
+    const auto [frame, len] = Encoded(n);
+    *output_len = len;
+    return cobs::Decode(output_buf, output_len, frame, len);
+  }
+
+  std::pair<Status, std::vector<uint8_t>> Decode(size_t n) const {
+    const auto [frame, len] = Encoded(n);
+    return cobs::Decode(frame, len);
+  }
+
+  // Whether the index holds CRC status built with "info".
+  template <int N>
+  bool HasCrcStatus(const typename crc::Crc<N>::Info *info) const {
+    return crc_bits_ == N && crc_check_ == CrcCheck<N>(info);
+  }
+
+  // CRC decode status of frame "n" if the index holds CRC status.
+  Status CrcStatus(size_t n) const { return static_cast<Status>(crc_status_[n]); }
+
+  // Frames [first, last) starting within the byte range [begin, end).
+  std::pair<size_t, size_t> FramesInRange(uint64_t begin, uint64_t end) const {
+    if (offsets_.empty()) {
+      return {0, 0};
+    }
+    const auto frames_begin = offsets_.begin();
+    const auto frames_end = offsets_.end() - 1;
+    const auto first = std::lower_bound(frames_begin, frames_end, begin);
+    const auto last = std::lower_bound(first, frames_end, std::max(begin, end));
+    return {static_cast<size_t>(first - frames_begin), static_cast<size_t>(last - frames_begin)};
+  }
+
+ private:
+  struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t crc_bits;
+    uint64_t capture_size;
+    int64_t capture_mtime_ns;
+    uint64_t num_frames;
+    uint32_t crc_check;
+    uint32_t reserved;
+  };
+
+  IndexHeader MakeHeader() const {
+    IndexHeader header{};
+    std::memcpy(header.magic, "COBSIDX", sizeof(header.magic));
+    header.version = 1;
+    header.crc_bits = crc_bits_;
+    header.capture_size = size_;
+    header.capture_mtime_ns = mtime_ns_;
+    header.num_frames = NumFrames();
+    header.crc_check = crc_check_;
+    return header;
+  }
+
+  // Identifies a CRC by its check value.
+  template <int N>
+  static uint32_t CrcCheck(const typename crc::Crc<N>::Info *info) {
+    static constexpr uint8_t kCheck[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    return crc::Crc<N>::Block(info, kCheck, sizeof(kCheck));
+  }
+
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  int64_t mtime_ns_ = 0;
+  std::vector<uint64_t> offsets_;  // Frame start offsets followed by the capture size.
+  std::vector<uint8_t> crc_status_;
+  uint32_t crc_bits_ = 0;
+  uint32_t crc_check_ = 0;
+};
+
+}  // namespace cobs
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "crc/cc_crc.h"
+
 extern "C" {
 #include "cobs/c_cobs.h"
 }
@@ -17,16 +23,62 @@ enum class Status {
   MalformedFrame = kCobsStatusMalformedFrame,
   Overflow = kCobsStatusOverflow,
   IncompleteFrame = kCobsStatusIncompleteFrame,
+  CrcError = kCobsStatusCrcError,
+};
+
+// Short lowercase name for printing, e.g. "ok" or "malformed".
+inline constexpr const char *StatusName(Status status) {
+  switch (status) {
+    case Status::Processing:
+      return "processing";
+    case Status::FrameAvailable:
+      return "ok";
+    case Status::MalformedFrame:
+      return "malformed";
+    case Status::Overflow:
+      return "overflow";
+    case Status::IncompleteFrame:
+      return "incomplete";
+    case Status::CrcError:
+      return "crc_error";
+  }
+  return "unknown";
+}
+
+// Encoding variant.  See CobsMode.
+enum class Mode {
+  Standard = kCobsModeStandard,
+  Reduced = kCobsModeReduced,
+  Zpe = kCobsModeZpe,
 };
 
 inline constexpr size_t MaxEncodeLen(size_t decode_len) {
   return COBS_MAX_ENCODE_LEN(decode_len);
 }
 
+inline constexpr size_t MaxEncodeLen(size_t decode_len, Mode mode) {
+  return mode == Mode::Zpe ? COBS_ZPE_MAX_ENCODE_LEN(decode_len) : COBS_MAX_ENCODE_LEN(decode_len);
+}
+
+inline constexpr size_t EncodeHeadroom(size_t decode_len) {
+  return COBS_ENCODE_HEADROOM(decode_len);
+}
+
 inline constexpr size_t MaxDecodeLen(size_t encode_len) {
   return COBS_MAX_DECODE_LEN(encode_len);
 }
 
+inline constexpr size_t MaxDecodeLen(size_t encode_len, Mode mode) {
+  switch (mode) {
+    case Mode::Reduced:
+      return COBS_R_MAX_DECODE_LEN(encode_len);
+    case Mode::Zpe:
+      return COBS_ZPE_MAX_DECODE_LEN(encode_len);
+    default:
+      return COBS_MAX_DECODE_LEN(encode_len);
+  }
+}
+
 inline size_t Encode(uint8_t *output_buf, const uint8_t *input_buf, size_t input_len) {
   return CobsEncodeBuffer(output_buf, input_buf, input_len);
 }
@@ -38,8 +90,48 @@ inline std::vector<uint8_t> Encode(const uint8_t *input_buf, size_t input_len) {
   return output;
 }
 
+inline size_t Encode(uint8_t *output_buf, const uint8_t *input_buf, size_t input_len, Mode mode) {
+  return CobsEncodeBufferMode(output_buf, input_buf, input_len, static_cast<CobsMode>(mode));
+}
+
+inline std::vector<uint8_t> Encode(const uint8_t *input_buf, size_t input_len, Mode mode) {
+  std::vector<uint8_t> output(MaxEncodeLen(input_len, mode));
+  size_t output_len = Encode(output.data(), input_buf, input_len, mode);
+  output.resize(output_len);
+  return output;
+}
+
+// Encode the "input_len" byte payload located "headroom" bytes into "buf" over itself.  The encoded
+// frame starts at "buf".  headroom must be at least EncodeHeadroom(input_len).
+inline size_t EncodeInPlace(uint8_t *buf, size_t headroom, size_t input_len) {
+  return CobsEncodeInPlace(buf, headroom, input_len);
+}
+
+#ifdef COBS_IOV
+// Encode the frame made of "iovcnt" segments as iovecs for writev(), referencing long runs within
+// the segments.  See CobsEncodeToIov() for the sizes of "scratch" and "out".  Returns the number of
+// iovecs written to "out" and their total length.
+inline std::pair<int, size_t> EncodeToIov(const iovec *iov, int iovcnt, uint8_t *scratch,
+                                          iovec *out) {
+  size_t encoded_len;
+  const int out_cnt = CobsEncodeToIov(iov, iovcnt, scratch, out, &encoded_len);
+  return {out_cnt, encoded_len};
+}
+#endif
+
+// Selects the in place Encoder constructor.
+struct InPlace {};
+
 class Encoder {
  public:
+  // In place constructor.  The payload is built at Payload(), EncodeHeadroom(max_payload_len)
+  // bytes into buf, and passed to Encode() in order as it is completed.  The frame is encoded over
+  // it, starting at buf.  buf must hold EncodeHeadroom(max_payload_len) + max_payload_len bytes.
+  Encoder(InPlace, uint8_t *buf, size_t max_payload_len)
+      : buf_ptr_{buf}, payload_ptr_{buf + EncodeHeadroom(max_payload_len)} {
+    Reset();
+  }
+
   // Non-allocating constructor.  output_buf must be large enough to hold entire encoded frame.
   // No overflow checking is performed.  See MaxEncodeLen()
   Encoder(uint8_t *output_buf) : buf_ptr_{output_buf} { Reset(); }
@@ -51,13 +143,33 @@ class Encoder {
   }
 
   // Resets encoder.
-  void Reset() { CobsEncodeStateInit(&state_, buf_ptr_); }
+  void Reset() {
+    CobsEncodeStateInit(&state_, buf_ptr_);
+    CobsEncodeStateSetMode(&state_, static_cast<CobsMode>(mode_));
+  }
+
+  // Select the encoding variant and reset the encoder.  The output buffer must hold
+  // MaxEncodeLen(len, mode).  The in place constructor supports Mode::Standard and Mode::Reduced.
+  void SetMode(Mode mode) {
+    mode_ = mode;
+    Reset();
+  }
+
+  // Start of the payload for the in place constructor, otherwise nullptr.
+  uint8_t *Payload() const { return payload_ptr_; }
 
   // Incrementally encode buffer.
   void Encode(const uint8_t *input_buf, size_t input_len) {
     CobsEncodeBlock(&state_, input_buf, input_len, false);
   }
 
+  // Incrementally encode several buffers, e.g. Encode({{header, 4}, {payload, len}}).
+  void Encode(std::initializer_list<std::pair<const uint8_t *, size_t>> segments) {
+    for (const auto &[input_buf, input_len] : segments) {
+      CobsEncodeBlock(&state_, input_buf, input_len, false);
+    }
+  }
+
   // Get pointer to encoded buffer and reset the encoder.  The pointer is valid until the next call
   // to Encode().
   std::pair<const uint8_t *, size_t> Get() {
@@ -79,6 +191,129 @@ class Encoder {
   CobsEncodeState state_;
   std::unique_ptr<uint8_t[]> buf_;
   uint8_t *const buf_ptr_;
+  uint8_t *const payload_ptr_ = nullptr;
+  Mode mode_ = Mode::Standard;
+};
+
+// Encoder which appends the CRC of the encoded data to each frame, computed in the same pass.
+template <int N>
+class CrcEncoder {
+ public:
+  using Info = typename crc::Crc<N>::Info;
+
+  static constexpr size_t kCrcLen = N / 8;
+
+  // Non-allocating constructor.  output_buf must be large enough to hold entire encoded frame
+  // including the CRC.  No overflow checking is performed.  See MaxEncodeLen()
+  CrcEncoder(const Info *info, uint8_t *output_buf) : info_{info}, buf_ptr_{output_buf} { Reset(); }
+
+  // Allocating constructor.  output_buf_size must be large enough to hold entire encoded frame
+  // including the CRC.  No overflow checking is performed.  See MaxEncodeLen()
+  CrcEncoder(const Info *info, size_t output_buf_size)
+      : info_{info}, buf_{new uint8_t[output_buf_size]}, buf_ptr_{buf_.get()} {
+    Reset();
+  }
+
+  // Resets encoder.
+  void Reset() {
+    if constexpr (N == 8) {
+      CobsEncodeStateInitCrc8(&state_, buf_ptr_, info_);
+    } else if constexpr (N == 16) {
+      CobsEncodeStateInitCrc16(&state_, buf_ptr_, info_);
+    } else if constexpr (N == 32) {
+      CobsEncodeStateInitCrc32(&state_, buf_ptr_, info_);
+    } else {
+      static_assert(crc::impl::always_false<N>::value, "Unsupported number of bits N.");
+    }
+    CobsEncodeStateSetMode(&state_, static_cast<CobsMode>(mode_));
+  }
+
+  // Select the encoding variant and reset the encoder.  The output buffer must hold
+  // MaxEncodeLen(len + kCrcLen, mode).
+  void SetMode(Mode mode) {
+    mode_ = mode;
+    Reset();
+  }
+
+  // Incrementally encode buffer.
+  void Encode(const uint8_t *input_buf, size_t input_len) {
+    CobsEncodeBlock(&state_, input_buf, input_len, false);
+  }
+
+  // Incrementally encode several buffers, e.g. Encode({{header, 4}, {payload, len}}).
+  void Encode(std::initializer_list<std::pair<const uint8_t *, size_t>> segments) {
+    for (const auto &[input_buf, input_len] : segments) {
+      CobsEncodeBlock(&state_, input_buf, input_len, false);
+    }
+  }
+
+  // Append CRC, get pointer to encoded buffer and reset the encoder.  The pointer is valid until
+  // the next call to Encode().
+  std::pair<const uint8_t *, size_t> Get() {
+    CobsEncodeBlock(&state_, nullptr, 0, true);
+    auto output = std::make_pair(state_.encoded, state_.len);
+    Reset();
+    return output;
+  }
+
+  // Append CRC, get copy of encoded buffer and reset the encoder.
+  std::vector<uint8_t> GetCopy() {
+    CobsEncodeBlock(&state_, nullptr, 0, true);
+    std::vector<uint8_t> output(state_.encoded, state_.encoded + state_.len);
+    Reset();
+    return output;
+  }
+
+ private:
+  const Info *const info_;
+  CobsEncodeState state_;
+  std::unique_ptr<uint8_t[]> buf_;
+  uint8_t *const buf_ptr_;
+  Mode mode_ = Mode::Standard;
+};
+
+// Cut-through encoder passing each group of the frame to "sink" as soon as its code byte is known,
+// so transmission can start before the frame is complete.  Uses a fixed 255 byte working buffer
+// regardless of frame length.  "sink" is called as sink(const uint8_t *data, size_t len) with data
+// valid only for the duration of the call, e.g.
+//   StreamEncoder encoder([&](const uint8_t *data, size_t len) { uart.Write(data, len); });
+template <typename Sink>
+class StreamEncoder {
+ public:
+  explicit StreamEncoder(Sink sink) : sink_{std::move(sink)} { Reset(); }
+
+  // The C state refers back to this object.
+  StreamEncoder(const StreamEncoder &) = delete;
+  StreamEncoder &operator=(const StreamEncoder &) = delete;
+
+  // Resets encoder, discarding the frame in progress.  Groups already passed to the sink remain
+  // sent.
+  void Reset() { CobsStreamEncodeStateInit(&state_, &StreamEncoder::Write, this); }
+
+  // Incrementally encode buffer.
+  void Encode(const uint8_t *input_buf, size_t input_len) {
+    CobsStreamEncodeBlock(&state_, input_buf, input_len, false);
+  }
+
+  // Incrementally encode several buffers, e.g. Encode({{header, 4}, {payload, len}}).
+  void Encode(std::initializer_list<std::pair<const uint8_t *, size_t>> segments) {
+    for (const auto &[input_buf, input_len] : segments) {
+      CobsStreamEncodeBlock(&state_, input_buf, input_len, false);
+    }
+  }
+
+  // Pass the rest of the frame and its delimiter to the sink and start a new frame.
+  void Finish() { CobsStreamEncodeBlock(&state_, nullptr, 0, true); }
+
+  Sink &GetSink() { return sink_; }
+
+ private:
+  static void Write(void *ctx, const uint8_t *data, size_t len) {
+    static_cast<StreamEncoder *>(ctx)->sink_(data, len);
+  }
+
+  Sink sink_;
+  CobsStreamEncodeState state_;
 };
 
 inline Status Decode(uint8_t *output_buf, size_t *output_len, const uint8_t *input_buf,
@@ -88,6 +323,12 @@ inline Status Decode(uint8_t *output_buf, size_t *output_len, const uint8_t *inp
   return status;
 }
 
+inline Status Decode(uint8_t *output_buf, size_t *output_len, const uint8_t *input_buf,
+                     size_t input_len, Mode mode) {
+  return static_cast<Status>(CobsDecodeBufferMode(output_buf, output_len, input_buf, input_len,
+                                                  static_cast<CobsMode>(mode)));
+}
+
 inline std::pair<Status, std::vector<uint8_t>> Decode(const uint8_t *input_buf, size_t input_len) {
   // Create buffer same size as input instead of MaxDecodeLen(input_len) so that incomplete frames
   // are flagged correctly instead of as overflows.
@@ -99,6 +340,65 @@ inline std::pair<Status, std::vector<uint8_t>> Decode(const uint8_t *input_buf,
   return {status, output};
 }
 
+inline std::pair<Status, std::vector<uint8_t>> Decode(const uint8_t *input_buf, size_t input_len,
+                                                      Mode mode) {
+  // At least the input size, as above.  Zero pairs may decode to more.
+  std::vector<uint8_t> output(std::max(input_len, MaxDecodeLen(input_len, mode)));
+  size_t output_len = output.size();
+  const Status status = Decode(output.data(), &output_len, input_buf, input_len, mode);
+  output.resize(output_len);
+  return {status, output};
+}
+
+// Decode the frame at the start of "buf" over the encoded data.  Returns the decoded frame, which
+// starts at "buf".
+inline std::pair<Status, std::pair<uint8_t *, size_t>> DecodeInPlace(uint8_t *buf, size_t len) {
+  size_t output_len;
+  const Status status = static_cast<Status>(CobsDecodeInPlace(buf, len, &output_len));
+  if (status != Status::FrameAvailable) {
+    return {status, {nullptr, 0}};
+  }
+  return {status, {buf, output_len}};
+}
+
+// Streaming decoder which decodes frames in place within its receive buffer.  Receive into
+// WritePtr(), Commit() the received length and call Next() until it returns Status::Processing.
+class InPlaceDecoder {
+ public:
+  InPlaceDecoder(uint8_t *buf, size_t size) : buf_ptr_{buf}, size_{size} { Reset(); }
+
+  InPlaceDecoder(size_t size) : buf_{new uint8_t[size]}, buf_ptr_{buf_.get()}, size_{size} {
+    Reset();
+  }
+
+  void Reset() { CobsDecodeInPlaceStateInit(&state_, buf_ptr_, size_); }
+
+  // Invalidates frames previously returned by Next().
+  std::pair<uint8_t *, size_t> WritePtr() {
+    size_t available;
+    uint8_t *ptr = CobsDecodeInPlaceWritePtr(&state_, &available);
+    return {ptr, available};
+  }
+
+  void Commit(size_t len) { CobsDecodeInPlaceCommit(&state_, len); }
+
+  std::pair<Status, std::pair<uint8_t *, size_t>> Next() {
+    uint8_t *frame;
+    size_t len;
+    Status status = static_cast<Status>(CobsDecodeInPlaceNext(&state_, &frame, &len));
+    if (status != Status::FrameAvailable) {
+      return {status, {nullptr, 0}};
+    }
+    return {status, {frame, len}};
+  }
+
+ private:
+  CobsDecodeInPlaceState state_;
+  std::unique_ptr<uint8_t[]> buf_;
+  uint8_t *const buf_ptr_;
+  const size_t size_;
+};
+
 class Decoder {
  public:
   Decoder(uint8_t *output_buf, size_t output_buf_len)
@@ -111,7 +411,92 @@ class Decoder {
     Reset();
   }
 
-  void Reset() { CobsDecodeStateInit(&state_, buf_ptr_, buf_len_); }
+  void Reset() {
+    CobsDecodeStateInit(&state_, buf_ptr_, buf_len_);
+    CobsDecodeStateSetMode(&state_, static_cast<CobsMode>(mode_));
+  }
+
+  // Select the encoding variant and reset the decoder.
+  void SetMode(Mode mode) {
+    mode_ = mode;
+    Reset();
+  }
+
+  std::pair<Status, std::pair<uint8_t *, size_t>> Decode(uint8_t byte) {
+    Status status = static_cast<Status>(CobsDecodeByte(&state_, byte));
+    if (status != Status::FrameAvailable) {
+      return {status, {nullptr, 0}};
+    }
+    return {status, {state_.decoded, state_.len}};
+  }
+
+  std::pair<Status, std::vector<uint8_t>> DecodeAndCopy(uint8_t byte) {
+    Status status = static_cast<Status>(CobsDecodeByte(&state_, byte));
+    if (status != Status::FrameAvailable) {
+      return {status, {}};
+    }
+    return {status, {state_.decoded, state_.decoded + state_.len}};
+  }
+
+  // Decode input up to and including the next frame delimiter or error, storing the number of
+  // bytes used in "consumed".  Call again with the remaining input to continue.
+  std::pair<Status, std::pair<uint8_t *, size_t>> Decode(const uint8_t *input_buf, size_t len,
+                                                         size_t *consumed) {
+    Status status = static_cast<Status>(CobsDecodeBlock(&state_, input_buf, len, consumed));
+    if (status != Status::FrameAvailable) {
+      return {status, {nullptr, 0}};
+    }
+    return {status, {state_.decoded, state_.len}};
+  }
+
+ private:
+  CobsDecodeState state_;
+  std::unique_ptr<uint8_t[]> buf_;
+  uint8_t *const buf_ptr_;
+  const size_t buf_len_;
+  Mode mode_ = Mode::Standard;
+};
+
+// Decoder which verifies and strips the CRC appended by CrcEncoder while decoding.  Frames failing
+// the check are reported as Status::CrcError.
+template <int N>
+class CrcDecoder {
+ public:
+  using Info = typename crc::Crc<N>::Info;
+
+  // output_buf_len must include room for the CRC.
+  CrcDecoder(const Info *info, uint8_t *output_buf, size_t output_buf_len)
+      : info_{info}, buf_ptr_{output_buf}, buf_len_{output_buf_len} {
+    Reset();
+  }
+
+  // output_buf_len must include room for the CRC.
+  CrcDecoder(const Info *info, size_t output_buf_len)
+      : info_{info},
+        buf_{new uint8_t[output_buf_len]},
+        buf_ptr_{buf_.get()},
+        buf_len_{output_buf_len} {
+    Reset();
+  }
+
+  void Reset() {
+    if constexpr (N == 8) {
+      CobsDecodeStateInitCrc8(&state_, buf_ptr_, buf_len_, info_);
+    } else if constexpr (N == 16) {
+      CobsDecodeStateInitCrc16(&state_, buf_ptr_, buf_len_, info_);
+    } else if constexpr (N == 32) {
+      CobsDecodeStateInitCrc32(&state_, buf_ptr_, buf_len_, info_);
+    } else {
+      static_assert(crc::impl::always_false<N>::value, "Unsupported number of bits N.");
+    }
+    CobsDecodeStateSetMode(&state_, static_cast<CobsMode>(mode_));
+  }
+
+  // Select the encoding variant and reset the decoder.
+  void SetMode(Mode mode) {
+    mode_ = mode;
+    Reset();
+  }
 
   std::pair<Status, std::pair<uint8_t *, size_t>> Decode(uint8_t byte) {
     Status status = static_cast<Status>(CobsDecodeByte(&state_, byte));
@@ -129,11 +514,222 @@ class Decoder {
     return {status, {state_.decoded, state_.decoded + state_.len}};
   }
 
+  // Decode input up to and including the next frame delimiter or error, storing the number of
+  // bytes used in "consumed".  Call again with the remaining input to continue.
+  std::pair<Status, std::pair<uint8_t *, size_t>> Decode(const uint8_t *input_buf, size_t len,
+                                                         size_t *consumed) {
+    Status status = static_cast<Status>(CobsDecodeBlock(&state_, input_buf, len, consumed));
+    if (status != Status::FrameAvailable) {
+      return {status, {nullptr, 0}};
+    }
+    return {status, {state_.decoded, state_.len}};
+  }
+
  private:
+  const Info *const info_;
   CobsDecodeState state_;
   std::unique_ptr<uint8_t[]> buf_;
   uint8_t *const buf_ptr_;
   const size_t buf_len_;
+  Mode mode_ = Mode::Standard;
+};
+
+class FramePool;
+
+// Move-only handle to a FramePool slot, returning it to the pool on destruction.
+class FrameHandle {
+ public:
+  FrameHandle() = default;
+
+  FrameHandle(FrameHandle &&other) noexcept
+      : pool_{std::exchange(other.pool_, nullptr)}, slot_{other.slot_}, size_{other.size_} {}
+
+  FrameHandle &operator=(FrameHandle &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      pool_ = std::exchange(other.pool_, nullptr);
+      slot_ = other.slot_;
+      size_ = other.size_;
+    }
+    return *this;
+  }
+
+  ~FrameHandle() { Reset(); }
+
+  explicit operator bool() const { return pool_ != nullptr; }
+
+  uint8_t *Data() const;
+  size_t Size() const { return size_; }
+  size_t Capacity() const;
+
+  // Set the frame length, at most Capacity().
+  void Resize(size_t size) { size_ = size; }
+
+  // Return the slot to the pool early.
+  void Reset();
+
+ private:
+  friend class FramePool;
+
+  FrameHandle(FramePool *pool, uint32_t slot, size_t size)
+      : pool_{pool}, slot_{slot}, size_{size} {}
+
+  FramePool *pool_ = nullptr;
+  uint32_t slot_ = 0;
+  size_t size_ = 0;
+};
+
+// Fixed number of equally sized frame buffers, acquired and released lock-free from any thread.
+// The pool must outlive its handles.
+class FramePool {
+ public:
+  FramePool(size_t num_slots, size_t slot_size)
+      : num_slots_{num_slots},
+        slot_size_{slot_size},
+        buf_{new uint8_t[num_slots * slot_size]},
+        next_{new std::atomic<uint32_t>[num_slots]} {
+    for (size_t i = 0; i < num_slots; ++i) {
+      next_[i].store(i + 1 < num_slots ? static_cast<uint32_t>(i + 1) : kNoSlot,
+                     std::memory_order_relaxed);
+    }
+    head_.store(num_slots ? 0 : kNoSlot, std::memory_order_relaxed);
+  }
+
+  FramePool(const FramePool &) = delete;
+  FramePool &operator=(const FramePool &) = delete;
+
+  // Handle to a free slot, sized to SlotSize(), or an empty handle if the pool is exhausted.
+  FrameHandle Acquire() {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t new_head;
+    do {
+      const uint32_t slot = static_cast<uint32_t>(head);
+      if (slot == kNoSlot) {
+        exhaustions_.fetch_add(1, std::memory_order_relaxed);
+        return {};
+      }
+      new_head = NextHead(head, next_[slot].load(std::memory_order_relaxed));
+    } while (!head_.compare_exchange_weak(head, new_head, std::memory_order_acquire,
+                                          std::memory_order_acquire));
+    in_use_.fetch_add(1, std::memory_order_relaxed);
+    return {this, static_cast<uint32_t>(head), slot_size_};
+  }
+
+  size_t Capacity() const { return num_slots_; }
+  size_t SlotSize() const { return slot_size_; }
+
+  // Number of slots currently held by handles.
+  size_t InUse() const { return in_use_.load(std::memory_order_relaxed); }
+
+  // Number of Acquire() calls which found the pool empty.
+  uint64_t Exhaustions() const { return exhaustions_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class FrameHandle;
+
+  static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+  // Head of the free list is the slot index in the low half and a modification count in the high
+  // half, so a compare-exchange fails if the head was popped and pushed back in between.
+  static uint64_t NextHead(uint64_t head, uint32_t slot) {
+    return ((head >> 32) + 1) << 32 | slot;
+  }
+
+  uint8_t *Data(uint32_t slot) const { return buf_.get() + slot * slot_size_; }
+
+  void Release(uint32_t slot) {
+    in_use_.fetch_sub(1, std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t new_head;
+    do {
+      next_[slot].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+      new_head = NextHead(head, slot);
+    } while (!head_.compare_exchange_weak(head, new_head, std::memory_order_release,
+                                          std::memory_order_relaxed));
+  }
+
+  const size_t num_slots_;
+  const size_t slot_size_;
+  std::unique_ptr<uint8_t[]> buf_;
+  std::unique_ptr<std::atomic<uint32_t>[]> next_;
+  std::atomic<uint64_t> head_;
+  std::atomic<size_t> in_use_{0};
+  std::atomic<uint64_t> exhaustions_{0};
+};
+
+inline uint8_t *FrameHandle::Data() const { return pool_ ? pool_->Data(slot_) : nullptr; }
+
+inline size_t FrameHandle::Capacity() const { return pool_ ? pool_->SlotSize() : 0; }
+
+inline void FrameHandle::Reset() {
+  if (pool_) {
+    std::exchange(pool_, nullptr)->Release(slot_);
+    size_ = 0;
+  }
+}
+
+// Decoder which decodes each frame directly into a FramePool slot and hands the slot over with the
+// completed frame, so frames can be passed between threads without copying or allocation.  Frames
+// arriving while the pool is exhausted are dropped and reported as Status::Overflow.
+class PooledDecoder {
+ public:
+  explicit PooledDecoder(FramePool &pool) : pool_{pool} {}
+
+  PooledDecoder(const PooledDecoder &) = delete;
+  PooledDecoder &operator=(const PooledDecoder &) = delete;
+
+  // Discards any frame in progress.
+  void Reset() {
+    frame_.Reset();
+    dropping_ = false;
+  }
+
+  std::pair<Status, FrameHandle> Decode(uint8_t byte) {
+    size_t consumed;
+    return Decode(&byte, 1, &consumed);
+  }
+
+  // Decode input up to and including the next frame delimiter or error, storing the number of
+  // bytes used in "consumed".  Call again with the remaining input to continue.
+  std::pair<Status, FrameHandle> Decode(const uint8_t *input_buf, size_t len, size_t *consumed) {
+    // Take a slot at the start of each frame.
+    if (!frame_ && !dropping_) {
+      if (len == 0) {
+        *consumed = 0;
+        return {Status::Processing, FrameHandle()};
+      }
+      frame_ = pool_.Acquire();
+      if (frame_) {
+        CobsDecodeStateInit(&state_, frame_.Data(), frame_.Capacity());
+      } else {
+        dropping_ = true;
+      }
+    }
+
+    if (dropping_) {
+      const void *delim = std::memchr(input_buf, 0x00, len);
+      if (!delim) {
+        *consumed = len;
+        return {Status::Processing, FrameHandle()};
+      }
+      *consumed = static_cast<size_t>(static_cast<const uint8_t *>(delim) - input_buf) + 1;
+      dropping_ = false;
+      return {Status::Overflow, FrameHandle()};
+    }
+
+    Status status = static_cast<Status>(CobsDecodeBlock(&state_, input_buf, len, consumed));
+    if (status != Status::FrameAvailable) {
+      return {status, FrameHandle()};
+    }
+    frame_.Resize(state_.len);
+    return {status, std::move(frame_)};
+  }
+
+ private:
+  FramePool &pool_;
+  FrameHandle frame_;
+  CobsDecodeState state_;
+  bool dropping_ = false;
 };
 
 }  // namespace cobs
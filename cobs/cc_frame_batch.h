@@ -0,0 +1,331 @@
+#pragma once
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "cobs/cc_cobs.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// Flushing through io_uring with UringWriter is available.
+#define COBS_IO_URING 1
+#endif
+
+namespace cobs {
+
+#ifdef COBS_IO_URING
+// Minimal single entry io_uring used to flush a FrameBatch with one io_uring_enter() per write,
+// without depending on liburing.  Not thread safe.
+class UringWriter {
+ public:
+  UringWriter() {
+    io_uring_params params{};
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, 1, &params));
+    if (ring_fd_ < 0) {
+      return;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+    cq_ring_ = single_mmap ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(Map(sqes_size_, IORING_OFF_SQES));
+    if (!sq_ring_ || !cq_ring_ || !sqes_) {
+      Close();
+      return;
+    }
+
+    auto *sq = static_cast<uint8_t *>(sq_ring_);
+    sq_tail_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+    auto *cq = static_cast<uint8_t *>(cq_ring_);
+    cq_head_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  }
+
+  UringWriter(const UringWriter &) = delete;
+  UringWriter &operator=(const UringWriter &) = delete;
+
+  ~UringWriter() { Close(); }
+
+  // Whether the kernel supports io_uring.  Write() fails with ENOSYS otherwise.
+  bool Ok() const { return ring_fd_ >= 0; }
+
+  // Write to "fd" at its current position, submitting and waiting for completion with a single
+  // io_uring_enter().  Returns as write() does.
+  ssize_t Write(int fd, const void *buf, size_t len) {
+    if (!Ok()) {
+      errno = ENOSYS;
+      return -1;
+    }
+
+    const uint32_t tail = *sq_tail_;
+    const uint32_t index = tail & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uintptr_t>(buf);
+    sqe->len = static_cast<uint32_t>(std::min<size_t>(len, std::numeric_limits<int32_t>::max()));
+    sqe->off = static_cast<uint64_t>(-1);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+    // A failed io_uring_enter() submitted nothing, so retry on EINTR with the same entry rather
+    // than queueing another, and otherwise take it back so the next Write() doesn't send it.
+    long submitted;
+    do {
+      submitted = syscall(__NR_io_uring_enter, ring_fd_, 1, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    } while (submitted < 0 && errno == EINTR);
+    if (submitted != 1) {
+      __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+      if (submitted >= 0) {
+        errno = EAGAIN;
+      }
+      return -1;
+    }
+
+    // The wait may be cut short by a signal after submitting.  "buf" must stay untouched and the
+    // completion must not be mistaken for the next Write()'s, so wait until it is reaped.
+    while (*cq_head_ == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+    const uint32_t head = *cq_head_;
+    const int32_t res = cqes_[head & cq_mask_].res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (res < 0) {
+      errno = -res;
+      return -1;
+    }
+    return res;
+  }
+
+ private:
+  void *Map(size_t size, off_t offset) {
+    void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                     offset);
+    return map == MAP_FAILED ? nullptr : map;
+  }
+
+  void Close() {
+    if (sqes_) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+    }
+    sqes_ = nullptr;
+    cq_ring_ = sq_ring_ = nullptr;
+    ring_fd_ = -1;
+  }
+
+  int ring_fd_ = -1;
+  void *sq_ring_ = nullptr;
+  void *cq_ring_ = nullptr;
+  io_uring_sqe *sqes_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  size_t cq_ring_size_ = 0;
+  size_t sqes_size_ = 0;
+  uint32_t *sq_tail_ = nullptr;
+  uint32_t sq_mask_ = 0;
+  uint32_t *sq_array_ = nullptr;
+  uint32_t *cq_head_ = nullptr;
+  uint32_t *cq_tail_ = nullptr;
+  uint32_t cq_mask_ = 0;
+  io_uring_cqe *cqes_ = nullptr;
+};
+#endif
+
+// When a FrameBatch should be flushed.  Thresholds left at their defaults never trigger.
+struct FlushPolicy {
+  size_t max_bytes = std::numeric_limits<size_t>::max();  // Queued bytes.
+  size_t max_frames = std::numeric_limits<size_t>::max();  // Queued frames.
+  std::chrono::steady_clock::duration max_delay =
+      std::chrono::steady_clock::duration::max();  // Age of the oldest queued frame.
+};
+
+// Encodes many frames back to back into one contiguous buffer so they can be sent with a single
+// write().  Appends are checked against the remaining space; when a frame does not fit, flush and
+// append it again.  Call ShouldFlush() after appending, or wait until Deadline(), to flush
+// according to the FlushPolicy.
+class FrameBatch {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Non-allocating constructor.  Frames are encoded into the "size" bytes at buf.
+  FrameBatch(uint8_t *buf, size_t size, FlushPolicy policy = {})
+      : buf_ptr_{buf}, size_{size}, policy_{policy} {}
+
+  // Allocating constructor.
+  explicit FrameBatch(size_t size, FlushPolicy policy = {})
+      : buf_{new uint8_t[size]}, buf_ptr_{buf_.get()}, size_{size}, policy_{policy} {}
+
+  // Encode a frame from "input_len" bytes onto the end of the batch.  Returns false, leaving the
+  // batch unchanged, if the encoded frame does not fit.
+  bool Append(const uint8_t *input_buf, size_t input_len) {
+    if (!Fits(input_buf, input_len)) {
+      return false;
+    }
+    Queued(CobsEncodeBuffer(buf_ptr_ + used_, input_buf, input_len));
+    return true;
+  }
+
+  // Encode a frame made of several buffers, e.g. Append({{header, 4}, {payload, len}}).
+  bool Append(std::initializer_list<std::pair<const uint8_t *, size_t>> segments) {
+    if (!Fits(segments)) {
+      return false;
+    }
+    CobsEncodeState state;
+    CobsEncodeStateInit(&state, buf_ptr_ + used_);
+    for (const auto &[input_buf, input_len] : segments) {
+      CobsEncodeBlock(&state, input_buf, input_len, false);
+    }
+    CobsEncodeBlock(&state, nullptr, 0, true);
+    Queued(state.len);
+    return true;
+  }
+
+  // Copy an already encoded frame, such as from Encoder::Get(), onto the end of the batch.
+  // Returns false, leaving the batch unchanged, if it does not fit.
+  bool AppendEncoded(const uint8_t *frame, size_t len) {
+    if (len > Remaining()) {
+      return false;
+    }
+    std::memcpy(buf_ptr_ + used_, frame, len);
+    Queued(len);
+    return true;
+  }
+
+  // Whether any FlushPolicy threshold has been reached.
+  bool ShouldFlush(Clock::time_point now = Clock::now()) const {
+    return frames_ > 0 && (Size() >= policy_.max_bytes || frames_ >= policy_.max_frames ||
+                           now - first_queued_ >= policy_.max_delay);
+  }
+
+  // When the oldest queued frame reaches the FlushPolicy delay, e.g. for a poll() timeout.
+  // Clock::time_point::max() if the batch is empty or there is no delay threshold.
+  Clock::time_point Deadline() const {
+    if (frames_ == 0 || policy_.max_delay > Clock::time_point::max() - first_queued_) {
+      return Clock::time_point::max();
+    }
+    return first_queued_ + policy_.max_delay;
+  }
+
+  // Write the batch to "fd" with as few write() calls as possible, normally one.  Returns true and
+  // clears the batch once everything is written.  On error, such as EAGAIN on a non-blocking fd,
+  // returns false with errno set and keeps the unwritten data for the next Flush().
+  bool Flush(int fd) {
+    return FlushWith([fd](const uint8_t *data, size_t len) { return write(fd, data, len); });
+  }
+
+#ifdef COBS_IO_URING
+  // Flush through "uring" rather than write().
+  bool Flush(UringWriter &uring, int fd) {
+    return FlushWith([&uring, fd](const uint8_t *data, size_t len) {
+      return uring.Write(fd, data, len);
+    });
+  }
+#endif
+
+  // Discard everything queued.
+  void Clear() {
+    used_ = 0;
+    sent_ = 0;
+    frames_ = 0;
+  }
+
+  // Queued data not yet written by Flush().
+  std::pair<const uint8_t *, size_t> Get() const { return {buf_ptr_ + sent_, Size()}; }
+
+  size_t Size() const { return used_ - sent_; }
+  size_t Frames() const { return frames_; }
+  size_t Capacity() const { return size_; }
+  size_t Remaining() const { return size_ - used_; }
+
+ private:
+  // Whether the frame encoded from "input_buf" fits, checking the exact encoded length only when
+  // the maximum does not fit.
+  bool Fits(const uint8_t *input_buf, size_t input_len) const {
+    return MaxEncodeLen(input_len) <= Remaining() ||
+           CobsEncodedLen(input_buf, input_len) <= Remaining();
+  }
+
+  bool Fits(std::initializer_list<std::pair<const uint8_t *, size_t>> segments) const {
+    size_t input_len = 0;
+    for (const auto &segment : segments) {
+      input_len += segment.second;
+    }
+    if (MaxEncodeLen(input_len) <= Remaining()) {
+      return true;
+    }
+    // Runs may span segments, so count the joined frame without writing it.
+    size_t encoded_len = 0;
+    StreamEncoder counter([&encoded_len](const uint8_t *, size_t len) { encoded_len += len; });
+    counter.Encode(segments);
+    counter.Finish();
+    return encoded_len <= Remaining();
+  }
+
+  void Queued(size_t len) {
+    if (frames_++ == 0) {
+      first_queued_ = Clock::now();
+    }
+    used_ += len;
+  }
+
+  template <typename WriteFn>
+  bool FlushWith(WriteFn write_fn) {
+    while (sent_ < used_) {
+      const ssize_t written = write_fn(buf_ptr_ + sent_, used_ - sent_);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written == 0) {
+        errno = EIO;
+      }
+      if (written <= 0) {
+        return false;
+      }
+      sent_ += static_cast<size_t>(written);
+    }
+    Clear();
+    return true;
+  }
+
+  std::unique_ptr<uint8_t[]> buf_;
+  uint8_t *const buf_ptr_;
+  const size_t size_;
+  const FlushPolicy policy_;
+  size_t used_ = 0;
+  size_t sent_ = 0;
+  size_t frames_ = 0;
+  Clock::time_point first_queued_;
+};
+
+}  // namespace cobs
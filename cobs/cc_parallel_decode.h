@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "cobs/cc_cobs.h"
+#include "util/thread_pool.h"
+
+namespace cobs {
+
+// Frame decoded by ParallelDecode.
+struct DecodedFrame {
+  Status status;
+  size_t offset;  // Offset of the encoded frame within the input.
+  size_t encoded_len;  // Input bytes making up the frame, including its delimiter.
+  const uint8_t *data;  // Decoded frame if status is Status::FrameAvailable, otherwise nullptr.
+  size_t len;
+};
+
+// Input bytes each ParallelDecode task works through.  Many more shards than threads keeps all
+// threads busy when frame sizes are uneven.
+inline constexpr size_t kParallelDecodeShard = 1 << 20;
+
+namespace impl {
+
+// Start of the first frame at or after "pos".  Frames start after a delimiter.
+inline size_t NextFrameStart(const uint8_t *input, size_t len, size_t pos) {
+  if (pos == 0 || pos >= len) {
+    return pos < len ? pos : len;
+  }
+  const void *delim = std::memchr(input + pos - 1, 0x00, len - (pos - 1));
+  return delim ? static_cast<size_t>(static_cast<const uint8_t *>(delim) - input) + 1 : len;
+}
+
+}  // namespace impl
+
+// Decode a buffer of back to back frames, such as a capture file, on "pool".  Input is split into
+// shards at frame delimiters, which reset the decoder, so the frames and statuses match decoding
+// the whole input sequentially.  Each frame is decoded into "output_buf" at its own input offset,
+// so output_buf must hold "len" bytes.  Trailing input without a delimiter is reported as
+// Status::IncompleteFrame.  Frames are returned in input order.
+inline std::vector<DecodedFrame> ParallelDecode(const uint8_t *input_buf, size_t len,
+                                                uint8_t *output_buf, util::ThreadPool &pool,
+                                                size_t shard_size = kParallelDecodeShard) {
+  const size_t num_shards = len ? (len + shard_size - 1) / shard_size : 0;
+  std::vector<std::vector<DecodedFrame>> shard_frames(num_shards);
+
+  pool.ParallelFor(num_shards, [&](size_t shard) {
+    const size_t start = impl::NextFrameStart(input_buf, len, shard * shard_size);
+    const size_t end = impl::NextFrameStart(input_buf, len, (shard + 1) * shard_size);
+    std::vector<DecodedFrame> &frames = shard_frames[shard];
+
+    CobsDecodeState state;
+    for (size_t pos = start; pos < end;) {
+      CobsDecodeStateInit(&state, output_buf + pos, end - pos);
+      size_t consumed;
+      Status status =
+          static_cast<Status>(CobsDecodeBlock(&state, input_buf + pos, end - pos, &consumed));
+      if (status == Status::Processing) {
+        status = Status::IncompleteFrame;
+      }
+      if (status == Status::FrameAvailable) {
+        frames.push_back({status, pos, consumed, state.decoded, state.len});
+      } else {
+        frames.push_back({status, pos, consumed, nullptr, 0});
+      }
+      pos += consumed;
+    }
+  });
+
+  size_t num_frames = 0;
+  for (const auto &frames : shard_frames) {
+    num_frames += frames.size();
+  }
+  std::vector<DecodedFrame> output;
+  output.reserve(num_frames);
+  for (const auto &frames : shard_frames) {
+    output.insert(output.end(), frames.begin(), frames.end());
+  }
+  return output;
+}
+
+}  // namespace cobs
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "cobs/cc_cobs.h"
+#include "util/thread_pool.h"
+
+namespace cobs {
+
+// Input bytes each ParallelEncode task works through.  Many more shards than threads keeps all
+// threads busy when message sizes are uneven.
+inline constexpr size_t kParallelEncodeShard = 1 << 18;
+
+namespace impl {
+
+// Split "messages" into consecutive shards of about "shard_size" input bytes.  Returns the index
+// of the first message of each shard followed by the number of messages.
+inline std::vector<size_t> ShardMessages(
+    const std::vector<std::pair<const uint8_t *, size_t>> &messages, size_t shard_size) {
+  std::vector<size_t> shards{0};
+  size_t bytes = 0;
+  for (size_t i = 0; i < messages.size(); ++i) {
+    // Count each message as at least one byte so shards of empty messages stay bounded too.
+    bytes += messages[i].second + 1;
+    if (bytes >= shard_size) {
+      shards.push_back(i + 1);
+      bytes = 0;
+    }
+  }
+  if (shards.back() != messages.size()) {
+    shards.push_back(messages.size());
+  }
+  return shards;
+}
+
+}  // namespace impl
+
+// Offsets of each message of "messages" encoded back to back, followed by the total encoded
+// length, computed on "pool" by counting runs with CobsEncodedLen.
+inline std::vector<size_t> ParallelEncodeOffsets(
+    const std::vector<std::pair<const uint8_t *, size_t>> &messages, util::ThreadPool &pool,
+    size_t shard_size = kParallelEncodeShard) {
+  const std::vector<size_t> shards = impl::ShardMessages(messages, shard_size);
+  std::vector<size_t> offsets(messages.size() + 1);
+  pool.ParallelFor(shards.size() - 1, [&](size_t shard) {
+    for (size_t i = shards[shard]; i < shards[shard + 1]; ++i) {
+      offsets[i + 1] = CobsEncodedLen(messages[i].first, messages[i].second);
+    }
+  });
+  for (size_t i = 1; i < offsets.size(); ++i) {
+    offsets[i] += offsets[i - 1];
+  }
+  return offsets;
+}
+
+// Encode "messages" back to back into "output_buf" on "pool", message i at offsets[i].  "offsets"
+// must come from ParallelEncodeOffsets and output_buf must hold offsets.back() bytes.  Output
+// matches encoding each message in turn with Encode.
+inline void ParallelEncode(const std::vector<std::pair<const uint8_t *, size_t>> &messages,
+                           const std::vector<size_t> &offsets, uint8_t *output_buf,
+                           util::ThreadPool &pool, size_t shard_size = kParallelEncodeShard) {
+  const std::vector<size_t> shards = impl::ShardMessages(messages, shard_size);
+  pool.ParallelFor(shards.size() - 1, [&](size_t shard) {
+    for (size_t i = shards[shard]; i < shards[shard + 1]; ++i) {
+      CobsEncodeBuffer(output_buf + offsets[i], messages[i].first, messages[i].second);
+    }
+  });
+}
+
+// Allocating version returning the encoded messages and their offsets.
+inline std::pair<std::vector<uint8_t>, std::vector<size_t>> ParallelEncode(
+    const std::vector<std::pair<const uint8_t *, size_t>> &messages, util::ThreadPool &pool,
+    size_t shard_size = kParallelEncodeShard) {
+  std::vector<size_t> offsets = ParallelEncodeOffsets(messages, pool, shard_size);
+  std::vector<uint8_t> output(offsets.back());
+  ParallelEncode(messages, offsets, output.data(), pool, shard_size);
+  return {std::move(output), std::move(offsets)};
+}
+
+}  // namespace cobs
@@ -0,0 +1,451 @@
+// CPython extension wrapping c_cobs for py_cobs.  Inputs are read in place through the buffer
+// protocol, so bytes, bytearray, memoryview and contiguous numpy arrays are all accepted without a
+// copy, and results are encoded or decoded directly into the returned bytes object.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cobs/c_cobs.h"
+
+// Inputs at least this long are processed with the GIL released so other threads can run.  Encoder
+// and Decoder hold state between calls and always keep the GIL.
+static const Py_ssize_t kCobsExtReleaseGilLen = 8192;
+
+typedef struct {
+  PyObject_HEAD
+  CobsEncodeState state;
+  uint8_t *buf;
+  size_t size;
+  size_t bytes_encoded;
+  CobsMode mode;
+} CobsEncoderObject;
+
+typedef struct {
+  PyObject_HEAD
+  CobsDecodeState state;
+  uint8_t *buf;
+  size_t size;
+  CobsMode mode;
+} CobsDecoderObject;
+
+static bool CobsExtParseMode(int value, CobsMode *mode) {
+  if (value < kCobsModeStandard || value >= kNumCobsMode) {
+    PyErr_Format(PyExc_ValueError, "Invalid mode: %d", value);
+    return false;
+  }
+  *mode = (CobsMode)value;
+  return true;
+}
+
+static size_t CobsExtMaxEncodeLen(size_t len, CobsMode mode) {
+  return mode == kCobsModeZpe ? COBS_ZPE_MAX_ENCODE_LEN(len) : COBS_MAX_ENCODE_LEN(len);
+}
+
+static size_t CobsExtMaxDecodeLen(size_t len, CobsMode mode) {
+  switch (mode) {
+    case kCobsModeReduced:
+      return COBS_R_MAX_DECODE_LEN(len);
+    case kCobsModeZpe:
+      return COBS_ZPE_MAX_DECODE_LEN(len);
+    default:
+      return COBS_MAX_DECODE_LEN(len);
+  }
+}
+
+static PyThreadState *CobsExtReleaseGil(Py_ssize_t len) {
+  return len >= kCobsExtReleaseGilLen ? PyEval_SaveThread() : NULL;
+}
+
+static void CobsExtAcquireGil(PyThreadState *thread) {
+  if (thread) {
+    PyEval_RestoreThread(thread);
+  }
+}
+
+// Allocate an uninitialized bytes object of "len" bytes to encode or decode into.
+static PyObject *CobsExtNewBytes(size_t len) {
+  if (len > PY_SSIZE_T_MAX) {
+    return PyErr_NoMemory();
+  }
+  return PyBytes_FromStringAndSize(NULL, (Py_ssize_t)len);
+}
+
+static PyObject *CobsExtEncode(PyObject *module, PyObject *args, PyObject *kwargs) {
+  (void)module;
+  static char *keywords[] = {"buf", "mode", NULL};
+  Py_buffer input;
+  int mode_value = kCobsModeStandard;
+  CobsMode mode;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|i:encode", keywords, &input, &mode_value)) {
+    return NULL;
+  }
+  if (!CobsExtParseMode(mode_value, &mode)) {
+    PyBuffer_Release(&input);
+    return NULL;
+  }
+
+  PyObject *output = CobsExtNewBytes(CobsExtMaxEncodeLen((size_t)input.len, mode));
+  if (!output) {
+    PyBuffer_Release(&input);
+    return NULL;
+  }
+  PyThreadState *thread = CobsExtReleaseGil(input.len);
+  const size_t output_len = CobsEncodeBufferMode((uint8_t *)PyBytes_AS_STRING(output), input.buf,
+                                                 (size_t)input.len, mode);
+  CobsExtAcquireGil(thread);
+  PyBuffer_Release(&input);
+
+  // Shrinks in place, at most the per group overhead is unused.
+  if (_PyBytes_Resize(&output, (Py_ssize_t)output_len) < 0) {
+    return NULL;
+  }
+  return output;
+}
+
+static PyObject *CobsExtEncodeInPlace(PyObject *module, PyObject *args) {
+  (void)module;
+  Py_buffer buf;
+  Py_ssize_t headroom;
+  if (!PyArg_ParseTuple(args, "w*n:encode_in_place", &buf, &headroom)) {
+    return NULL;
+  }
+  if (headroom < 0 || headroom > buf.len ||
+      (size_t)headroom < COBS_ENCODE_HEADROOM((size_t)(buf.len - headroom))) {
+    PyBuffer_Release(&buf);
+    PyErr_SetString(PyExc_ValueError, "Insufficient headroom.");
+    return NULL;
+  }
+
+  PyThreadState *thread = CobsExtReleaseGil(buf.len);
+  const size_t output_len =
+      CobsEncodeInPlace(buf.buf, (size_t)headroom, (size_t)(buf.len - headroom));
+  CobsExtAcquireGil(thread);
+  PyBuffer_Release(&buf);
+  return PyLong_FromSize_t(output_len);
+}
+
+static PyObject *CobsExtDecode(PyObject *module, PyObject *args, PyObject *kwargs) {
+  (void)module;
+  static char *keywords[] = {"buf", "mode", NULL};
+  Py_buffer input;
+  int mode_value = kCobsModeStandard;
+  CobsMode mode;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|i:decode", keywords, &input, &mode_value)) {
+    return NULL;
+  }
+  if (!CobsExtParseMode(mode_value, &mode)) {
+    PyBuffer_Release(&input);
+    return NULL;
+  }
+
+  // At least the input length rather than the maximum decoded length so that incomplete frames are
+  // flagged correctly instead of as overflows.
+  size_t output_len = CobsExtMaxDecodeLen((size_t)input.len, mode);
+  if (output_len < (size_t)input.len) {
+    output_len = (size_t)input.len;
+  }
+  PyObject *output = CobsExtNewBytes(output_len);
+  if (!output) {
+    PyBuffer_Release(&input);
+    return NULL;
+  }
+  PyThreadState *thread = CobsExtReleaseGil(input.len);
+  const CobsStatus status = CobsDecodeBufferMode((uint8_t *)PyBytes_AS_STRING(output), &output_len,
+                                                 input.buf, (size_t)input.len, mode);
+  CobsExtAcquireGil(thread);
+  PyBuffer_Release(&input);
+
+  if (status != kCobsStatusFrameAvailable) {
+    Py_DECREF(output);
+    return Py_BuildValue("(iO)", status, Py_None);
+  }
+  if (_PyBytes_Resize(&output, (Py_ssize_t)output_len) < 0) {
+    return NULL;
+  }
+  return Py_BuildValue("(iN)", status, output);
+}
+
+static PyObject *CobsExtDecodeInPlace(PyObject *module, PyObject *args) {
+  (void)module;
+  Py_buffer buf;
+  if (!PyArg_ParseTuple(args, "w*:decode_in_place", &buf)) {
+    return NULL;
+  }
+
+  size_t output_len = 0;
+  PyThreadState *thread = CobsExtReleaseGil(buf.len);
+  const CobsStatus status = CobsDecodeInPlace(buf.buf, (size_t)buf.len, &output_len);
+  CobsExtAcquireGil(thread);
+  PyBuffer_Release(&buf);
+  return Py_BuildValue("(in)", status, (Py_ssize_t)output_len);
+}
+
+static void CobsEncoderReset(CobsEncoderObject *self) {
+  self->bytes_encoded = 0;
+  CobsEncodeStateInit(&self->state, self->buf);
+  CobsEncodeStateSetMode(&self->state, self->mode);
+}
+
+static int CobsEncoderInit(CobsEncoderObject *self, PyObject *args, PyObject *kwargs) {
+  static char *keywords[] = {"max_encoded_len", "mode", NULL};
+  Py_ssize_t size;
+  int mode_value = kCobsModeStandard;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|i:Encoder", keywords, &size, &mode_value)) {
+    return -1;
+  }
+  if (size < 0) {
+    PyErr_SetString(PyExc_ValueError, "max_encoded_len must not be negative.");
+    return -1;
+  }
+  if (!CobsExtParseMode(mode_value, &self->mode)) {
+    return -1;
+  }
+
+  PyMem_Free(self->buf);
+  self->buf = PyMem_Malloc((size_t)size);
+  if (!self->buf) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  self->size = (size_t)size;
+  CobsEncoderReset(self);
+  return 0;
+}
+
+static void CobsEncoderDealloc(CobsEncoderObject *self) {
+  PyMem_Free(self->buf);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *CobsEncoderResetMethod(CobsEncoderObject *self, PyObject *unused) {
+  (void)unused;
+  CobsEncoderReset(self);
+  Py_RETURN_NONE;
+}
+
+static PyObject *CobsEncoderEncode(CobsEncoderObject *self, PyObject *arg) {
+  Py_buffer input;
+  if (PyObject_GetBuffer(arg, &input, PyBUF_SIMPLE) < 0) {
+    return NULL;
+  }
+  const size_t bytes_encoded = self->bytes_encoded + (size_t)input.len;
+  if (CobsExtMaxEncodeLen(bytes_encoded, self->mode) > self->size) {
+    PyBuffer_Release(&input);
+    PyErr_SetString(PyExc_RuntimeError, "Buffer overflow.  Increase \"max_encoded_len\".");
+    return NULL;
+  }
+  CobsEncodeBlock(&self->state, input.buf, (size_t)input.len, false);
+  self->bytes_encoded = bytes_encoded;
+  PyBuffer_Release(&input);
+  Py_RETURN_NONE;
+}
+
+static PyObject *CobsEncoderGet(CobsEncoderObject *self, PyObject *unused) {
+  (void)unused;
+  if (CobsExtMaxEncodeLen(self->bytes_encoded, self->mode) > self->size) {
+    PyErr_SetString(PyExc_RuntimeError, "Buffer overflow.  Increase \"max_encoded_len\".");
+    return NULL;
+  }
+  CobsEncodeBlock(&self->state, NULL, 0, true);
+  PyObject *output =
+      PyBytes_FromStringAndSize((const char *)self->buf, (Py_ssize_t)self->state.len);
+  CobsEncoderReset(self);
+  return output;
+}
+
+static PyMethodDef kCobsEncoderMethods[] = {
+    {"reset", (PyCFunction)CobsEncoderResetMethod, METH_NOARGS, "Reset encoder."},
+    {"encode", (PyCFunction)CobsEncoderEncode, METH_O, "Incrementally COBS encode bytes."},
+    {"get", (PyCFunction)CobsEncoderGet, METH_NOARGS, "Get encoded bytes and reset encoder."},
+    {NULL, NULL, 0, NULL},
+};
+
+static PyTypeObject kCobsEncoderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)  // Trailing comma is part of the macro.
+    .tp_name = "cobs_ext.Encoder",
+    .tp_doc = "Encoder(max_encoded_len, mode=0)\n\nIncremental COBS Encoder.",
+    .tp_basicsize = sizeof(CobsEncoderObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)CobsEncoderInit,
+    .tp_dealloc = (destructor)CobsEncoderDealloc,
+    .tp_methods = kCobsEncoderMethods,
+};
+
+static void CobsDecoderReset(CobsDecoderObject *self) {
+  CobsDecodeStateInit(&self->state, self->buf, self->size);
+  CobsDecodeStateSetMode(&self->state, self->mode);
+}
+
+static int CobsDecoderInit(CobsDecoderObject *self, PyObject *args, PyObject *kwargs) {
+  static char *keywords[] = {"max_decoded_len", "mode", NULL};
+  Py_ssize_t size;
+  int mode_value = kCobsModeStandard;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|i:Decoder", keywords, &size, &mode_value)) {
+    return -1;
+  }
+  if (size < 0) {
+    PyErr_SetString(PyExc_ValueError, "max_decoded_len must not be negative.");
+    return -1;
+  }
+  if (!CobsExtParseMode(mode_value, &self->mode)) {
+    return -1;
+  }
+
+  PyMem_Free(self->buf);
+  self->buf = PyMem_Malloc((size_t)size);
+  if (!self->buf) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  self->size = (size_t)size;
+  CobsDecoderReset(self);
+  return 0;
+}
+
+static void CobsDecoderDealloc(CobsDecoderObject *self) {
+  PyMem_Free(self->buf);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *CobsDecoderResetMethod(CobsDecoderObject *self, PyObject *unused) {
+  (void)unused;
+  CobsDecoderReset(self);
+  Py_RETURN_NONE;
+}
+
+// Decoded frame if "status" is kCobsStatusFrameAvailable, otherwise None.
+static PyObject *CobsDecoderFrame(CobsDecoderObject *self, CobsStatus status) {
+  if (status != kCobsStatusFrameAvailable) {
+    Py_RETURN_NONE;
+  }
+  return PyBytes_FromStringAndSize((const char *)self->state.decoded,
+                                   (Py_ssize_t)self->state.len);
+}
+
+static PyObject *CobsDecoderDecode(CobsDecoderObject *self, PyObject *args) {
+  unsigned char byte;
+  if (!PyArg_ParseTuple(args, "b:decode", &byte)) {
+    return NULL;
+  }
+  const CobsStatus status = CobsDecodeByte(&self->state, byte);
+  return Py_BuildValue("(iN)", status, CobsDecoderFrame(self, status));
+}
+
+static PyObject *CobsDecoderDecodeBlock(CobsDecoderObject *self, PyObject *arg) {
+  Py_buffer input;
+  if (PyObject_GetBuffer(arg, &input, PyBUF_SIMPLE) < 0) {
+    return NULL;
+  }
+  size_t consumed = 0;
+  const CobsStatus status =
+      CobsDecodeBlock(&self->state, input.buf, (size_t)input.len, &consumed);
+  PyBuffer_Release(&input);
+  return Py_BuildValue("(iNn)", status, CobsDecoderFrame(self, status), (Py_ssize_t)consumed);
+}
+
+static PyObject *CobsDecoderFeed(CobsDecoderObject *self, PyObject *arg) {
+  Py_buffer input;
+  if (PyObject_GetBuffer(arg, &input, PyBUF_SIMPLE) < 0) {
+    return NULL;
+  }
+  PyObject *frames = PyList_New(0);
+  const uint8_t *input_ptr = input.buf;
+  size_t remaining = (size_t)input.len;
+  while (frames && remaining > 0) {
+    size_t consumed = 0;
+    const CobsStatus status = CobsDecodeBlock(&self->state, input_ptr, remaining, &consumed);
+    input_ptr += consumed;
+    remaining -= consumed;
+    if (status == kCobsStatusProcessing) {
+      continue;
+    }
+
+    PyObject *frame = Py_BuildValue("(iN)", status, CobsDecoderFrame(self, status));
+    if (!frame || PyList_Append(frames, frame) < 0) {
+      Py_XDECREF(frame);
+      Py_CLEAR(frames);
+      break;
+    }
+    Py_DECREF(frame);
+  }
+  PyBuffer_Release(&input);
+  return frames;
+}
+
+static PyMethodDef kCobsDecoderMethods[] = {
+    {"reset", (PyCFunction)CobsDecoderResetMethod, METH_NOARGS, "Reset decoder."},
+    {"decode", (PyCFunction)CobsDecoderDecode, METH_VARARGS,
+     "decode(byte) -> (status, bytes | None)\n\nIncrementally COBS decode byte."},
+    {"decode_block", (PyCFunction)CobsDecoderDecodeBlock, METH_O,
+     "decode_block(buf) -> (status, bytes | None, consumed)\n\nIncrementally COBS decode bytes up "
+     "to and including the next frame delimiter or error."},
+    {"feed", (PyCFunction)CobsDecoderFeed, METH_O,
+     "feed(buf) -> list[(status, bytes | None)]\n\nIncrementally COBS decode all of a buffer, "
+     "returning every frame and error completed within it.  A frame in progress at the end of the "
+     "buffer is continued by the next call."},
+    {NULL, NULL, 0, NULL},
+};
+
+static PyTypeObject kCobsDecoderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)  // Trailing comma is part of the macro.
+    .tp_name = "cobs_ext.Decoder",
+    .tp_doc = "Decoder(max_decoded_len, mode=0)\n\nIncremental COBS Decoder.",
+    .tp_basicsize = sizeof(CobsDecoderObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)CobsDecoderInit,
+    .tp_dealloc = (destructor)CobsDecoderDealloc,
+    .tp_methods = kCobsDecoderMethods,
+};
+
+static PyMethodDef kCobsExtMethods[] = {
+    {"encode", (PyCFunction)(void (*)(void))CobsExtEncode, METH_VARARGS | METH_KEYWORDS,
+     "encode(buf, mode=0) -> bytes\n\nCOBS encode a buffer."},
+    {"encode_in_place", CobsExtEncodeInPlace, METH_VARARGS,
+     "encode_in_place(buf, headroom) -> int\n\nCOBS encode the payload following \"headroom\" "
+     "bytes of a writable buffer over itself.  Returns the encoded length."},
+    {"decode", (PyCFunction)(void (*)(void))CobsExtDecode, METH_VARARGS | METH_KEYWORDS,
+     "decode(buf, mode=0) -> (status, bytes | None)\n\nCOBS decode a buffer."},
+    {"decode_in_place", CobsExtDecodeInPlace, METH_VARARGS,
+     "decode_in_place(buf) -> (status, int)\n\nCOBS decode the frame at the start of a writable "
+     "buffer over the encoded bytes.  Returns status and decoded length."},
+    {NULL, NULL, 0, NULL},
+};
+
+static struct PyModuleDef kCobsExtModule = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "cobs_ext",
+    .m_doc = "Native COBS bindings used by py_cobs.",
+    .m_size = -1,
+    .m_methods = kCobsExtMethods,
+};
+
+static int CobsExtAddType(PyObject *module, const char *name, PyTypeObject *type) {
+  if (PyType_Ready(type) < 0) {
+    return -1;
+  }
+  Py_INCREF(type);
+  if (PyModule_AddObject(module, name, (PyObject *)type) < 0) {
+    Py_DECREF(type);
+    return -1;
+  }
+  return 0;
+}
+
+PyMODINIT_FUNC PyInit_cobs_ext(void) {
+  PyObject *module = PyModule_Create(&kCobsExtModule);
+  if (!module) {
+    return NULL;
+  }
+  if (CobsExtAddType(module, "Encoder", &kCobsEncoderType) < 0 ||
+      CobsExtAddType(module, "Decoder", &kCobsDecoderType) < 0) {
+    Py_DECREF(module);
+    return NULL;
+  }
+  return module;
+}
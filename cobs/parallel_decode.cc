@@ -0,0 +1,99 @@
+// Decodes a raw capture of back to back COBS frames on all cores.
+//
+// Usage: parallel_decode [--threads N] [--frames] CAPTURE
+//
+// Prints a summary of frame statuses.  --frames additionally prints the offset, encoded length,
+// status and decoded length of every frame in order.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "cobs/cc_parallel_decode.h"
+#include "util/thread_pool.h"
+
+namespace {
+
+int Usage(const char *argv0) {
+  std::fprintf(stderr, "Usage: %s [--threads N] [--frames] CAPTURE\n", argv0);
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t threads = 0;
+  bool print_frames = false;
+  const char *path = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--frames") == 0) {
+      print_frames = true;
+    } else if (!path && argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      return Usage(argv[0]);
+    }
+  }
+  if (!path) {
+    return Usage(argv[0]);
+  }
+
+  const int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    std::perror(path);
+    return 1;
+  }
+  const size_t len = static_cast<size_t>(st.st_size);
+  const uint8_t *input = nullptr;
+  if (len > 0) {
+    void *map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      std::perror("mmap");
+      return 1;
+    }
+    input = static_cast<const uint8_t *>(map);
+  }
+  close(fd);
+
+  std::unique_ptr<uint8_t[]> output{new uint8_t[len]};
+  util::ThreadPool pool(threads);
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto frames = cobs::ParallelDecode(input, len, output.get(), pool);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::array<size_t, kNumCobsStatus> counts{};
+  for (const auto &frame : frames) {
+    counts[static_cast<size_t>(frame.status)]++;
+    if (print_frames) {
+      std::printf("%zu %zu %s %zu\n", frame.offset, frame.encoded_len,
+                  cobs::StatusName(frame.status), frame.len);
+    }
+  }
+
+  const double mb_per_s = static_cast<double>(len) / elapsed.count() / 1e6;
+  std::fprintf(stderr, "%zu bytes, %zu frames in %.3f s (%.1f MB/s, %zu threads)\n", len,
+               frames.size(), elapsed.count(), mb_per_s, pool.Size());
+  for (size_t status = 0; status < counts.size(); ++status) {
+    if (counts[status]) {
+      std::fprintf(stderr, "  %s: %zu\n", cobs::StatusName(static_cast<cobs::Status>(status)),
+                   counts[status]);
+    }
+  }
+
+  if (input) {
+    munmap(const_cast<uint8_t *>(input), len);
+  }
+  return 0;
+}
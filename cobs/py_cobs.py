@@ -1,5 +1,7 @@
-import ctypes
 import enum
+from typing import Iterator, NamedTuple
+
+from cobs import cobs_ext
 
 
 class Status(enum.IntEnum):
@@ -9,163 +11,124 @@ class Status(enum.IntEnum):
   MalformedFrame = 2
   Overflow = 3
   IncompleteFrame = 4
+  CrcError = 5
+
+
+class Mode(enum.IntEnum):
+  '''Encoding variant'''
+  Standard = 0  # COBS
+  Reduced = 1  # COBS/R, usually one byte shorter.
+  Zpe = 2  # COBS/ZPE, pairs of zeros encode to a single byte.
+
+
+class Frame(NamedTuple):
+  '''Frame or error completed by Decoder.feed()'''
+  status: Status
+  data: bytes | None  # Decoded bytes if status is FrameAvailable.
+
+
+_STATUS = tuple(Status)
 
 
-class _EncodeState(ctypes.Structure):
-  _fields_ = [
-      ('encoded', ctypes.POINTER(ctypes.c_uint8)),
-      ('len', ctypes.c_size_t),
-      ('_delim_ptr', ctypes.POINTER(ctypes.c_uint8)),
-      ('_write_ptr', ctypes.POINTER(ctypes.c_uint8)),
-      ('_delim_cnt', ctypes.c_uint8),
-  ]
-
-
-class _DecodeState(ctypes.Structure):
-  _fields_ = [
-      ('decoded', ctypes.POINTER(ctypes.c_uint8)),
-      ('len', ctypes.c_size_t),
-      ('_write_ptr', ctypes.POINTER(ctypes.c_uint8)),
-      ('_end_ptr', ctypes.POINTER(ctypes.c_uint8)),
-      ('_delim_cnt', ctypes.c_uint8),
-      ('_mandatory_delim', ctypes.c_bool),
-  ]
-
-
-class _CobsStatus(ctypes.c_int):
-
-  def enum(self) -> Status:
-    return Status(self.value)
-
-
-_lib = ctypes.cdll.LoadLibrary('cobs/c_cobs.so')
-
-_lib.CobsEncodeStateInit.argtypes = [ctypes.POINTER(_EncodeState), ctypes.POINTER(ctypes.c_uint8)]
-_lib.CobsEncodeStateInit.restype = None
-
-_lib.CobsEncodeBlock.argtypes = [
-    ctypes.POINTER(_EncodeState),
-    ctypes.POINTER(ctypes.c_uint8),
-    ctypes.c_size_t,
-    ctypes.c_bool,
-]
-_lib.CobsEncodeBlock.restype = None
-
-_lib.CobsEncodeBuffer.argtypes = [
-    ctypes.POINTER(ctypes.c_uint8),
-    ctypes.POINTER(ctypes.c_uint8),
-    ctypes.c_size_t,
-]
-_lib.CobsEncodeBuffer.restype = ctypes.c_size_t
-
-_lib.CobsDecodeStateInit.argtypes = [
-    ctypes.POINTER(_DecodeState),
-    ctypes.POINTER(ctypes.c_uint8),
-    ctypes.c_size_t,
-]
-_lib.CobsDecodeStateInit.restype = None
-
-_lib.CobsDecodeByte.argtypes = [
-    ctypes.POINTER(_DecodeState),
-    ctypes.c_uint8,
-]
-_lib.CobsDecodeByte.restype = _CobsStatus
-
-_lib.CobsDecodeBuffer.argtypes = [
-    ctypes.POINTER(ctypes.c_uint8),
-    ctypes.POINTER(ctypes.c_size_t),
-    ctypes.POINTER(ctypes.c_uint8),
-    ctypes.c_size_t,
-]
-_lib.CobsDecodeBuffer.restype = _CobsStatus
-
-
-def max_encode_len(decoded_len: int) -> int:
+def max_encode_len(decoded_len: int, mode: Mode = Mode.Standard) -> int:
   '''Maximum encoded length given a decoded length.'''
+  group_len = 223 if mode == Mode.Zpe else 254
   if decoded_len > 0:
-    return decoded_len + (decoded_len + 253) // 254 + 1
+    return decoded_len + (decoded_len + group_len - 1) // group_len + 1
   return 2
 
 
-def max_decode_len(encoded_len: int) -> int:
-  '''Maximum decoded length given an encoded length.'''
-  if encoded_len > 1:
-    return encoded_len - 2
-  return 0
+def encode_headroom(decoded_len: int) -> int:
+  '''Headroom needed in front of a payload to encode it in place.'''
+  return max_encode_len(decoded_len) - decoded_len
 
 
-def encode(buf: bytes) -> bytes:
-  '''COBS encode bytes'''
-  output = (ctypes.c_uint8 * max_encode_len(len(buf)))()
-  input = (ctypes.c_uint8 * len(buf)).from_buffer_copy(buf)
-  output_len = _lib.CobsEncodeBuffer(output, input, len(input))
-  return bytes(output[:output_len])
+def max_decode_len(encoded_len: int, mode: Mode = Mode.Standard) -> int:
+  '''Maximum decoded length given an encoded length.'''
+  if encoded_len <= 1:
+    return 0
+  if mode == Mode.Reduced:
+    return encoded_len - 1
+  if mode == Mode.Zpe:
+    return 2 * (encoded_len - 1) - 1
+  return encoded_len - 2
 
 
-def decode(buf: bytes) -> tuple[Status, bytes | None]:
-  '''COBS decode bytes.  Returns status and optionally successfully decoded bytes.'''
-  # Create buffer same size as input instead of max_decode_len(len(buf)) so that incomplete frames
-  # are flagged correctly instead of as overflows.
-  output = (ctypes.c_uint8 * len(buf))()
-  output_len = ctypes.c_size_t(len(output))
-  input = (ctypes.c_uint8 * len(buf)).from_buffer_copy(buf)
-  status = _lib.CobsDecodeBuffer(output, output_len, input, len(input)).enum()
+def encode(buf, mode: Mode = Mode.Standard) -> bytes:
+  '''COBS encode any contiguous buffer: bytes, bytearray, memoryview, numpy array, etc.'''
+  return cobs_ext.encode(buf, mode)
 
-  if status != Status.FrameAvailable:
-    return status, None
 
-  return status, bytes(output[:output_len.value])
+def encode_in_place(buf: bytearray, headroom: int) -> memoryview:
+  '''COBS encode the payload following headroom bytes of buf over itself.  headroom must be at least
+  encode_headroom() of the payload length.  Returns a view of the encoded bytes within buf.'''
+  return memoryview(buf)[:cobs_ext.encode_in_place(buf, headroom)]
 
 
-class Encoder:
-  '''Incremental COBS Encoder.'''
+def decode(buf, mode: Mode = Mode.Standard) -> tuple[Status, bytes | None]:
+  '''COBS decode any contiguous buffer.  Returns status and optionally successfully decoded
+  bytes.'''
+  status, output = cobs_ext.decode(buf, mode)
+  return _STATUS[status], output
 
-  def __init__(self, max_encoded_len: int):
-    '''Create encoder capable of encoding "max_encoded_len" output buffer.'''
-    self._state = _EncodeState()
-    self._buf = (ctypes.c_uint8 * max_encoded_len)()
-    self.reset()
 
-  def reset(self):
-    '''Reset encoder.'''
-    self._bytes_encoded = 0
-    _lib.CobsEncodeStateInit(self._state, self._buf)
+def decode_in_place(buf: bytearray) -> tuple[Status, memoryview | None]:
+  '''COBS decode the frame at the start of buf over the encoded bytes.  Returns status and
+  optionally a view of the decoded bytes within buf.'''
+  status, output_len = cobs_ext.decode_in_place(buf)
 
-  def encode(self, buf: bytes):
-    '''Incrementally COBS encode bytes.'''
-    self._bytes_encoded += len(buf)
-    if max_encode_len(self._bytes_encoded) > len(self._buf):
-      raise RuntimeError('Buffer overflow.  Increase "max_encoded_len".')
+  if status != Status.FrameAvailable:
+    return _STATUS[status], None
 
-    input = (ctypes.c_uint8 * len(buf)).from_buffer_copy(buf)
-    _lib.CobsEncodeBlock(self._state, input, len(input), False)
+  return _STATUS[status], memoryview(buf)[:output_len]
 
-  def get(self) -> bytes:
-    '''Get encoded bytes and reset encoder.'''
-    _lib.CobsEncodeBlock(self._state, None, 0, True)
-    output = bytes(self._state.encoded[:self._state.len])
-    self.reset()
-    return output
 
+class Encoder(cobs_ext.Encoder):
+  '''Incremental COBS Encoder.
 
-class Decoder:
-  '''Incremental COBS Decoder.'''
+  Encoder(max_encoded_len, mode) creates an encoder capable of encoding into a "max_encoded_len"
+  output buffer.  encode(buf) incrementally COBS encodes any contiguous buffer, raising RuntimeError
+  if the output would overflow.  get() returns the encoded bytes and resets the encoder.
+  '''
 
-  def __init__(self, max_decoded_len: int):
-    '''Create decoder capable of decoding "max_decoded_len" output buffer.'''
-    self._state = _DecodeState()
-    self._buf = (ctypes.c_uint8 * max_decoded_len)()
-    self.reset()
 
-  def reset(self):
-    '''Reset decoder.'''
-    _lib.CobsDecodeStateInit(self._state, self._buf, len(self._buf))
+class Decoder(cobs_ext.Decoder):
+  '''Incremental COBS Decoder.
+
+  Decoder(max_decoded_len, mode) creates a decoder capable of decoding into a "max_decoded_len"
+  output buffer.  reset() discards any frame in progress.
+  '''
 
   def decode(self, byte: int) -> tuple[Status, bytes | None]:
     '''Incrementally COBS decode byte.  Returns status and optionally successfully decoded bytes.'''
-    status = _lib.CobsDecodeByte(self._state, byte).enum()
-
-    if status != Status.FrameAvailable:
-      return status, None
-
-    return status, bytes(self._state.decoded[:self._state.len])
+    status, output = cobs_ext.Decoder.decode(self, byte)
+    return _STATUS[status], output
+
+  def decode_block(self, buf) -> tuple[Status, bytes | None, int]:
+    '''Incrementally COBS decode bytes up to and including the next frame delimiter or error.
+
+    Returns status, optionally successfully decoded bytes, and the number of bytes of "buf" used.
+    Call again with the remaining bytes to continue.
+    '''
+    status, output, consumed = cobs_ext.Decoder.decode_block(self, buf)
+    return _STATUS[status], output, consumed
+
+  def feed(self, chunk) -> list[Frame]:
+    '''Incrementally COBS decode a whole chunk, such as a read() result, in one call.
+
+    Returns every frame and error completed within the chunk, in order.  A frame in progress at the
+    end of the chunk is continued by the next call.
+    '''
+    return [Frame(_STATUS[status], data) for status, data in cobs_ext.Decoder.feed(self, chunk)]
+
+  def feed_iter(self, chunk) -> Iterator[Frame]:
+    '''Generator form of feed(), decoding up to each frame only as it is requested.
+
+    The chunk stays exported, e.g. a bytearray cannot be resized, until the generator is exhausted.
+    '''
+    view = memoryview(chunk).cast('B')
+    while view:
+      status, data, consumed = cobs_ext.Decoder.decode_block(self, view)
+      view = view[consumed:]
+      if status != Status.Processing:
+        yield Frame(_STATUS[status], data)
@@ -0,0 +1,189 @@
+import asyncio
+import collections
+from typing import AsyncIterator, Iterable
+
+from cobs import py_cobs
+
+
+class FrameWriter:
+  '''Encodes frames into a buffer written to "transport" once per event loop iteration, so frames
+  written together cost a single transport.write().
+
+  "transport" may be an asyncio transport or StreamWriter.  The buffer is written early once it
+  reaches "max_buffered" bytes.
+  '''
+
+  def __init__(self, transport, mode: py_cobs.Mode = py_cobs.Mode.Standard,
+               max_buffered: int = 1 << 16):
+    self._transport = transport
+    self._mode = mode
+    self._max_buffered = max_buffered
+    self._buf = bytearray()
+    self._flush_handle: asyncio.Handle | None = None
+
+  def write(self, payload) -> None:
+    '''Encode a frame from any contiguous buffer and queue it.'''
+    self._buf += py_cobs.encode(payload, self._mode)
+    self._queued()
+
+  def write_many(self, payloads: Iterable) -> None:
+    '''Encode and queue a frame from each payload.'''
+    for payload in payloads:
+      self._buf += py_cobs.encode(payload, self._mode)
+    self._queued()
+
+  def write_encoded(self, frame) -> None:
+    '''Queue an already encoded frame, such as from Encoder.get().'''
+    self._buf += frame
+    self._queued()
+
+  def flush(self) -> None:
+    '''Write everything queued now.'''
+    if self._flush_handle:
+      self._flush_handle.cancel()
+      self._flush_handle = None
+    if self._buf:
+      # Hand the buffer over, transports may keep a reference to unsent data.
+      buf, self._buf = self._buf, bytearray()
+      self._transport.write(buf)
+
+  async def drain(self) -> None:
+    '''Flush, then wait for a StreamWriter's flow control.'''
+    self.flush()
+    drain = getattr(self._transport, 'drain', None)
+    if drain:
+      await drain()
+
+  def buffered(self) -> int:
+    '''Bytes queued but not yet written.'''
+    return len(self._buf)
+
+  def _queued(self):
+    if len(self._buf) >= self._max_buffered:
+      self.flush()
+    elif self._flush_handle is None and self._buf:
+      self._flush_handle = asyncio.get_running_loop().call_soon(self.flush)
+
+
+class FrameProtocol(asyncio.Protocol):
+  '''Protocol decoding received data into frames, delivered by async iteration.
+
+  async for frame in protocol yields py_cobs.Frame for each frame and error received, ending at EOF.
+  Reading is paused while "max_queued" frames are waiting to be iterated and resumed once half
+  have been.  write() sends frames coalesced by a FrameWriter, await drain() for flow control.
+  '''
+
+  def __init__(self, max_decoded_len: int, mode: py_cobs.Mode = py_cobs.Mode.Standard,
+               max_queued: int = 256):
+    self._decoder = py_cobs.Decoder(max_decoded_len, mode)
+    self._mode = mode
+    self._max_queued = max_queued
+    self._frames: collections.deque[py_cobs.Frame] = collections.deque()
+    self._transport: asyncio.BaseTransport | None = None
+    self._writer: FrameWriter | None = None
+    self._reading_paused = False
+    self._writing_paused = False
+    self._closed = False
+    self._exception: Exception | None = None
+    self._frame_waiter: asyncio.Future | None = None
+    self._drain_waiters: collections.deque[asyncio.Future] = collections.deque()
+
+  def connection_made(self, transport):
+    self._transport = transport
+    self._writer = FrameWriter(transport, self._mode)
+
+  def data_received(self, data):
+    self._frames.extend(self._decoder.feed(data))
+    self._wake_frame_waiter()
+    if not self._reading_paused and len(self._frames) >= self._max_queued:
+      self._transport.pause_reading()
+      self._reading_paused = True
+
+  def eof_received(self):
+    self._closed = True
+    self._wake_frame_waiter()
+
+  def connection_lost(self, exc):
+    self._closed = True
+    self._exception = exc
+    self._wake_frame_waiter()
+    self._wake_drain_waiters()
+
+  def pause_writing(self):
+    self._writing_paused = True
+
+  def resume_writing(self):
+    self._writing_paused = False
+    self._wake_drain_waiters()
+
+  def write(self, payload) -> None:
+    '''Encode a frame from any contiguous buffer and send it, coalesced with other writes.'''
+    self._writer.write(payload)
+
+  def write_many(self, payloads: Iterable) -> None:
+    '''Encode a frame from each payload and send them in one write.'''
+    self._writer.write_many(payloads)
+
+  def write_encoded(self, frame) -> None:
+    '''Send an already encoded frame, coalesced with other writes.'''
+    self._writer.write_encoded(frame)
+
+  async def drain(self) -> None:
+    '''Send queued frames and wait until the transport accepts more.'''
+    self._writer.flush()
+    if self._closed:
+      raise self._exception or ConnectionResetError('Connection lost.')
+    if self._writing_paused:
+      waiter = asyncio.get_running_loop().create_future()
+      self._drain_waiters.append(waiter)
+      try:
+        await waiter
+      finally:
+        self._drain_waiters.remove(waiter)
+
+  def __aiter__(self) -> AsyncIterator[py_cobs.Frame]:
+    return self
+
+  async def __anext__(self) -> py_cobs.Frame:
+    while not self._frames:
+      if self._closed:
+        if self._exception:
+          raise self._exception
+        raise StopAsyncIteration
+      self._frame_waiter = asyncio.get_running_loop().create_future()
+      try:
+        await self._frame_waiter
+      finally:
+        self._frame_waiter = None
+
+    frame = self._frames.popleft()
+    if self._reading_paused and len(self._frames) <= self._max_queued // 2 and not self._closed:
+      self._reading_paused = False
+      self._transport.resume_reading()
+    return frame
+
+  def _wake_frame_waiter(self):
+    if self._frame_waiter and not self._frame_waiter.done():
+      self._frame_waiter.set_result(None)
+
+  def _wake_drain_waiters(self):
+    for waiter in self._drain_waiters:
+      if not waiter.done():
+        if self._closed:
+          waiter.set_exception(self._exception or ConnectionResetError('Connection lost.'))
+        else:
+          waiter.set_result(None)
+
+
+async def read_frames(reader: asyncio.StreamReader, max_decoded_len: int,
+                      mode: py_cobs.Mode = py_cobs.Mode.Standard,
+                      read_size: int = 1 << 16) -> AsyncIterator[py_cobs.Frame]:
+  '''Yield py_cobs.Frame for each frame and error read from "reader" until EOF.  Each read() is
+  decoded in a single Decoder.feed() call.  The StreamReader's own limit provides backpressure.'''
+  decoder = py_cobs.Decoder(max_decoded_len, mode)
+  while True:
+    chunk = await reader.read(read_size)
+    if not chunk:
+      return
+    for frame in decoder.feed(chunk):
+      yield frame
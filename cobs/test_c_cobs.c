@@ -1,8 +1,10 @@
 #include <stdint.h>
+#include <string.h>
 
 #include "external/unity/src/unity.h"
 
 #include "cobs/c_cobs.h"
+#include "crc/all_crcs.h"
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
@@ -289,6 +291,199 @@ static void TestCobsEncodeBlock(void) {
   }
 }
 
+typedef struct {
+  uint8_t data[2048];
+  size_t len;
+} StreamSink;
+
+static void StreamSinkWrite(void *ctx, const uint8_t *data, size_t len) {
+  StreamSink *sink = ctx;
+  TEST_ASSERT_TRUE(len <= sizeof(sink->data) - sink->len);
+  memcpy(&sink->data[sink->len], data, len);
+  sink->len += len;
+}
+
+static void TestCobsStreamEncodeBlock(void) {
+  static StreamSink sink;
+  CobsStreamEncodeState state;
+  CobsStreamEncodeStateInit(&state, StreamSinkWrite, &sink);
+
+  const size_t block_sizes[] = {1, 25, 1000};
+  for (size_t b = 0; b < ARRAY_SIZE(block_sizes); ++b) {
+    for (size_t i = 0; i < ARRAY_SIZE(g_test_vectors); ++i) {
+      Array input = g_test_vectors[i].input;
+      Array output = g_test_vectors[i].output;
+      const char *message = g_test_vectors[i].message;
+
+      sink.len = 0;
+      size_t j = 0;
+      while (j + block_sizes[b] < input.len) {
+        CobsStreamEncodeBlock(&state, &input.data[j], block_sizes[b], false);
+        j += block_sizes[b];
+      }
+      CobsStreamEncodeBlock(&state, &input.data[j], input.len - j, true);
+
+      TEST_ASSERT_EQUAL_INT32_MESSAGE(output.len, sink.len, message);
+      TEST_ASSERT_EQUAL_HEX8_ARRAY_MESSAGE(output.data, sink.data, output.len, message);
+    }
+  }
+
+  // Groups are passed on as soon as they are complete.
+  uint8_t input[300];
+  memset(input, 0x5A, sizeof(input));
+  input[10] = 0x00;
+  sink.len = 0;
+  CobsStreamEncodeBlock(&state, input, 5, false);
+  TEST_ASSERT_EQUAL_INT32(0, sink.len);
+  CobsStreamEncodeBlock(&state, &input[5], 6, false);
+  TEST_ASSERT_EQUAL_INT32(11, sink.len);
+  CobsStreamEncodeBlock(&state, &input[11], 254, false);
+  TEST_ASSERT_EQUAL_INT32(11 + 255, sink.len);
+  CobsStreamEncodeBlock(&state, &input[265], sizeof(input) - 265, true);
+
+  uint8_t expected[COBS_MAX_ENCODE_LEN(sizeof(input))];
+  const size_t expected_len = CobsEncodeBuffer(expected, input, sizeof(input));
+  TEST_ASSERT_EQUAL_INT32(expected_len, sink.len);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, sink.data, expected_len);
+}
+
+static void TestCobsEncodeInPlace(void) {
+  const CobsKernel original = CobsGetKernel();
+  for (int kernel = 0; kernel < kNumCobsKernel; ++kernel) {
+    if (!CobsSetKernel((CobsKernel)kernel)) {
+      continue;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(g_test_vectors); ++i) {
+      Array input = g_test_vectors[i].input;
+      Array output = g_test_vectors[i].output;
+      const char *message = g_test_vectors[i].message;
+
+      const size_t headroom = COBS_ENCODE_HEADROOM(input.len);
+      uint8_t buf[headroom + input.len];
+      memcpy(&buf[headroom], input.data, input.len);
+
+      const size_t len = CobsEncodeInPlace(buf, headroom, input.len);
+
+      TEST_ASSERT_EQUAL_INT32_MESSAGE(output.len, len, message);
+      TEST_ASSERT_EQUAL_HEX8_ARRAY_MESSAGE(output.data, buf, output.len, message);
+    }
+
+    // Long runs, each needing several extra code bytes.
+    static uint8_t payload[5000];
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+      payload[i] = i % 700 ? (uint8_t)(i % 251 + 1) : 0;
+    }
+    static uint8_t expected[COBS_MAX_ENCODE_LEN(sizeof(payload))];
+    const size_t expected_len = CobsEncodeBuffer(expected, payload, sizeof(payload));
+
+    static uint8_t buf[COBS_MAX_ENCODE_LEN(sizeof(payload))];
+    const size_t headroom = COBS_ENCODE_HEADROOM(sizeof(payload));
+    memcpy(&buf[headroom], payload, sizeof(payload));
+    TEST_ASSERT_EQUAL_INT32(expected_len, CobsEncodeInPlace(buf, headroom, sizeof(payload)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf, expected_len);
+
+    // Incrementally, with extra headroom.
+    static uint8_t buf_block[COBS_MAX_ENCODE_LEN(sizeof(payload)) + 10];
+    memcpy(&buf_block[headroom + 10], payload, sizeof(payload));
+    CobsEncodeState state;
+    CobsEncodeStateInit(&state, buf_block);
+    for (size_t j = 0; j < sizeof(payload); j += 1000) {
+      CobsEncodeBlock(&state, &buf_block[headroom + 10 + j], 1000, j + 1000 == sizeof(payload));
+    }
+    TEST_ASSERT_EQUAL_INT32(expected_len, state.len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf_block, expected_len);
+  }
+  TEST_ASSERT_TRUE(CobsSetKernel(original));
+}
+
+static void CheckEncodeIov(const struct iovec *iov, int iovcnt, const uint8_t *expected,
+                           size_t expected_len, const char *message) {
+  uint8_t actual[expected_len + 1];
+  actual[expected_len] = 0xAA;
+  CobsEncodeState state;
+  CobsEncodeStateInit(&state, actual);
+  CobsEncodeIov(&state, iov, iovcnt, true);
+  TEST_ASSERT_EQUAL_INT32_MESSAGE(expected_len, state.len, message);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE(0xAA, actual[expected_len], message);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY_MESSAGE(expected, actual, expected_len, message);
+
+  size_t frame_len = 0;
+  for (int i = 0; i < iovcnt; ++i) {
+    frame_len += iov[i].iov_len;
+  }
+  uint8_t scratch[COBS_MAX_ENCODE_LEN(frame_len)];
+  struct iovec out[COBS_MAX_IOV_OUT(frame_len)];
+  size_t encoded_len;
+  const int out_cnt = CobsEncodeToIov(iov, iovcnt, scratch, out, &encoded_len);
+  TEST_ASSERT_TRUE_MESSAGE(out_cnt > 0 && (size_t)out_cnt <= ARRAY_SIZE(out), message);
+  TEST_ASSERT_EQUAL_INT32_MESSAGE(expected_len, encoded_len, message);
+
+  size_t j = 0;
+  for (int i = 0; i < out_cnt; ++i) {
+    TEST_ASSERT_TRUE_MESSAGE(out[i].iov_len > 0, message);
+    TEST_ASSERT_TRUE_MESSAGE(j + out[i].iov_len <= expected_len, message);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY_MESSAGE(&expected[j], out[i].iov_base, out[i].iov_len, message);
+    j += out[i].iov_len;
+  }
+  TEST_ASSERT_EQUAL_INT32_MESSAGE(expected_len, j, message);
+}
+
+static void TestCobsEncodeIov(void) {
+  for (size_t i = 0; i < ARRAY_SIZE(g_test_vectors); ++i) {
+    Array input = g_test_vectors[i].input;
+    Array output = g_test_vectors[i].output;
+    const char *message = g_test_vectors[i].message;
+
+    // Every split into three segments, including empty ones.
+    for (size_t a = 0; a <= input.len; a += 7) {
+      for (size_t b = a; b <= input.len; b += 31) {
+        const struct iovec iov[] = {
+            {(void *)input.data, a},
+            {(void *)&input.data[a], b - a},
+            {(void *)&input.data[b], input.len - b},
+        };
+        CheckEncodeIov(iov, 3, output.data, output.len, message);
+      }
+    }
+  }
+
+  // Header, long payload and trailer.
+  uint8_t header[] = {0x11, 0x00, 0x22, 0x33};
+  static uint8_t payload[3000];
+  for (size_t i = 0; i < sizeof(payload); ++i) {
+    payload[i] = i % 700 ? (uint8_t)(i % 251 + 1) : 0;
+  }
+  uint8_t trailer[] = {0x44, 0x00};
+  static uint8_t frame[sizeof(header) + sizeof(payload) + sizeof(trailer)];
+  memcpy(frame, header, sizeof(header));
+  memcpy(&frame[sizeof(header)], payload, sizeof(payload));
+  memcpy(&frame[sizeof(header) + sizeof(payload)], trailer, sizeof(trailer));
+  static uint8_t expected[COBS_MAX_ENCODE_LEN(sizeof(frame))];
+  const size_t expected_len = CobsEncodeBuffer(expected, frame, sizeof(frame));
+
+  const struct iovec iov[] = {
+      {header, sizeof(header)},
+      {payload, sizeof(payload)},
+      {trailer, sizeof(trailer)},
+  };
+  CheckEncodeIov(iov, ARRAY_SIZE(iov), expected, expected_len, "Header, payload, trailer.");
+
+  // Long runs are referenced in place.
+  static uint8_t scratch[COBS_MAX_ENCODE_LEN(sizeof(frame))];
+  struct iovec out[COBS_MAX_IOV_OUT(sizeof(frame))];
+  size_t encoded_len;
+  const int out_cnt = CobsEncodeToIov(iov, ARRAY_SIZE(iov), scratch, out, &encoded_len);
+  size_t referenced = 0;
+  for (int i = 0; i < out_cnt; ++i) {
+    const uint8_t *base = out[i].iov_base;
+    if (base >= payload && base < payload + sizeof(payload)) {
+      referenced += out[i].iov_len;
+    }
+  }
+  TEST_ASSERT_TRUE(referenced > sizeof(payload) / 2);
+}
+
 static void TestCobsMaxEncodeLen(void) {
   TEST_ASSERT_EQUAL_INT32(2, COBS_MAX_ENCODE_LEN(-1));
   TEST_ASSERT_EQUAL_INT32(2, COBS_MAX_ENCODE_LEN(0));
@@ -299,6 +494,15 @@ static void TestCobsMaxEncodeLen(void) {
   TEST_ASSERT_EQUAL_INT32(513, COBS_MAX_ENCODE_LEN(509));
 }
 
+static void TestCobsEncodeHeadroom(void) {
+  TEST_ASSERT_EQUAL_INT32(2, COBS_ENCODE_HEADROOM(0));
+  TEST_ASSERT_EQUAL_INT32(2, COBS_ENCODE_HEADROOM(1));
+  TEST_ASSERT_EQUAL_INT32(2, COBS_ENCODE_HEADROOM(254));
+  TEST_ASSERT_EQUAL_INT32(3, COBS_ENCODE_HEADROOM(255));
+  TEST_ASSERT_EQUAL_INT32(3, COBS_ENCODE_HEADROOM(508));
+  TEST_ASSERT_EQUAL_INT32(4, COBS_ENCODE_HEADROOM(509));
+}
+
 static void TestCobsMaxDecodeLen(void) {
   TEST_ASSERT_EQUAL_INT32(0, COBS_MAX_DECODE_LEN(-1));
   TEST_ASSERT_EQUAL_INT32(0, COBS_MAX_DECODE_LEN(0));
@@ -308,13 +512,682 @@ static void TestCobsMaxDecodeLen(void) {
   TEST_ASSERT_EQUAL_INT32(1000, COBS_MAX_DECODE_LEN(1002));
 }
 
+static uint8_t g_crc_input[3000];
+
+static void FillCrcInput(void) {
+  uint32_t x = 1;
+  for (size_t i = 0; i < sizeof(g_crc_input); ++i) {
+    x = x * 1103515245 + 12345;
+    // Sprinkle in delimiters.
+    g_crc_input[i] = i % 61 ? (uint8_t)(x >> 16) : 0;
+  }
+}
+
+// Encode "len" bytes of g_crc_input in blocks, decode, and check the payload is followed by "crc"
+// in transmission order.
+static void CheckEncodeCrc(CobsEncodeState *state, size_t len, uint32_t crc, size_t crc_len,
+                           bool lsb_first) {
+  const size_t kBlockSize = 700;
+  size_t j = 0;
+  while (j + kBlockSize < len) {
+    CobsEncodeBlock(state, &g_crc_input[j], kBlockSize, false);
+    j += kBlockSize;
+  }
+  CobsEncodeBlock(state, &g_crc_input[j], len - j, true);
+  TEST_ASSERT_TRUE(state->len <= COBS_MAX_ENCODE_LEN(len + crc_len));
+
+  uint8_t decoded[sizeof(g_crc_input) + sizeof(uint32_t)];
+  size_t decoded_len = sizeof(decoded);
+  TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable,
+                        CobsDecodeBuffer(decoded, &decoded_len, state->encoded, state->len));
+  TEST_ASSERT_EQUAL_INT32(len + crc_len, decoded_len);
+  if (len) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(g_crc_input, decoded, len);
+  }
+  for (size_t i = 0; i < crc_len; ++i) {
+    const size_t shift = 8 * (lsb_first ? i : crc_len - 1 - i);
+    TEST_ASSERT_EQUAL_HEX8((uint8_t)(crc >> shift), decoded[len + i]);
+  }
+}
+
+static void TestCobsEncodeCrc(void) {
+  FillCrcInput();
+  const size_t lens[] = {0, 1, 61, 254, 1024, 1500, sizeof(g_crc_input)};
+  uint8_t encoded[COBS_MAX_ENCODE_LEN(sizeof(g_crc_input) + sizeof(uint32_t))];
+
+  for (size_t i = 0; i < ARRAY_SIZE(lens); ++i) {
+    const size_t len = lens[i];
+    CobsEncodeState state;
+
+    CobsEncodeStateInitCrc8(&state, encoded, &kCrc8ICodeInfo);
+    CheckEncodeCrc(&state, len, Crc8Block(&kCrc8ICodeInfo, g_crc_input, len), 1, false);
+
+    CobsEncodeStateInitCrc16(&state, encoded, &kCrc16KermitInfo);
+    CheckEncodeCrc(&state, len, Crc16Block(&kCrc16KermitInfo, g_crc_input, len), 2, true);
+
+    CobsEncodeStateInitCrc16(&state, encoded, &kCrc16CcittFalseInfo);
+    CheckEncodeCrc(&state, len, Crc16Block(&kCrc16CcittFalseInfo, g_crc_input, len), 2, false);
+
+    CobsEncodeStateInitCrc32(&state, encoded, &kCrc32Info);
+    CheckEncodeCrc(&state, len, Crc32Block(&kCrc32Info, g_crc_input, len), 4, true);
+
+    CobsEncodeStateInitCrc32(&state, encoded, &kCrc32Mpeg2Info);
+    CheckEncodeCrc(&state, len, Crc32Block(&kCrc32Mpeg2Info, g_crc_input, len), 4, false);
+
+    // Without a trailing residue the CRC over the whole frame is zero.
+    uint8_t decoded[sizeof(g_crc_input) + sizeof(uint32_t)];
+    size_t decoded_len = sizeof(decoded);
+    CobsDecodeBuffer(decoded, &decoded_len, state.encoded, state.len);
+    TEST_ASSERT_EQUAL_HEX32(0, Crc32Block(&kCrc32Mpeg2Info, decoded, decoded_len));
+  }
+}
+
+// Decode "frame" one byte at a time, returning the final status.
+static CobsStatus DecodeBytes(CobsDecodeState *state, const uint8_t *frame, size_t len) {
+  CobsStatus status = kCobsStatusIncompleteFrame;
+  for (size_t i = 0; i < len; ++i) {
+    status = CobsDecodeByte(state, frame[i]);
+  }
+  return status;
+}
+
+static void TestCobsDecodeCrc(void) {
+  FillCrcInput();
+  const size_t lens[] = {0, 1, 61, 254, 1500, sizeof(g_crc_input)};
+  uint8_t encoded[COBS_MAX_ENCODE_LEN(sizeof(g_crc_input) + sizeof(uint32_t))];
+  uint8_t raw[sizeof(g_crc_input) + sizeof(uint32_t)];
+  uint8_t decoded[sizeof(g_crc_input) + sizeof(uint32_t)];
+
+  for (size_t i = 0; i < ARRAY_SIZE(lens); ++i) {
+    const size_t len = lens[i];
+    CobsEncodeState enc;
+    CobsDecodeState dec;
+
+    CobsEncodeStateInitCrc16(&enc, encoded, &kCrc16CcittFalseInfo);
+    CobsEncodeBlock(&enc, g_crc_input, len, true);
+    CobsDecodeStateInitCrc16(&dec, decoded, sizeof(decoded), &kCrc16CcittFalseInfo);
+    TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable, DecodeBytes(&dec, encoded, enc.len));
+    TEST_ASSERT_EQUAL_INT32(len, dec.len);
+    if (len) {
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(g_crc_input, decoded, len);
+    }
+
+    CobsEncodeStateInitCrc32(&enc, encoded, &kCrc32Info);
+    CobsEncodeBlock(&enc, g_crc_input, len, true);
+    CobsDecodeStateInitCrc32(&dec, decoded, sizeof(decoded), &kCrc32Info);
+    TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable, DecodeBytes(&dec, encoded, enc.len));
+    TEST_ASSERT_EQUAL_INT32(len, dec.len);
+
+    // Corrupt the last CRC byte and re-encode without a CRC.
+    size_t raw_len = sizeof(raw);
+    TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable,
+                          CobsDecodeBuffer(raw, &raw_len, encoded, enc.len));
+    raw[raw_len - 1] ^= 0x01;
+    const size_t bad_len = CobsEncodeBuffer(encoded, raw, raw_len);
+    TEST_ASSERT_EQUAL_INT(kCobsStatusCrcError, DecodeBytes(&dec, encoded, bad_len));
+
+    // Decoder recovers for the next frame.
+    raw[raw_len - 1] ^= 0x01;
+    const size_t good_len = CobsEncodeBuffer(encoded, raw, raw_len);
+    TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable, DecodeBytes(&dec, encoded, good_len));
+    TEST_ASSERT_EQUAL_INT32(len, dec.len);
+  }
+
+  // Frames shorter than the CRC.
+  CobsDecodeState dec;
+  CobsDecodeStateInitCrc32(&dec, decoded, sizeof(decoded), &kCrc32Info);
+  const uint8_t short_frame[] = {0x04, 0x11, 0x22, 0x33, 0x00};
+  TEST_ASSERT_EQUAL_INT(kCobsStatusCrcError, DecodeBytes(&dec, short_frame, sizeof(short_frame)));
+}
+
+typedef struct {
+  CobsStatus status;
+  size_t len;
+  uint32_t sum;  // Cheap digest of the decoded frame.
+} DecodeEvent;
+
+static size_t RecordEvent(DecodeEvent *events, size_t num_events, CobsStatus status,
+                          const CobsDecodeState *state) {
+  DecodeEvent event = {status, 0, 0};
+  if (status == kCobsStatusFrameAvailable) {
+    event.len = state->len;
+    for (size_t i = 0; i < state->len; ++i) {
+      event.sum = event.sum * 31 + state->decoded[i];
+    }
+  }
+  events[num_events] = event;
+  return num_events + 1;
+}
+
+// Feed "stream" to fresh decoders byte by byte and in blocks of "chunk" bytes, comparing every
+// status reported.
+static void CheckDecodeBlock(const uint8_t *stream, size_t stream_len, size_t output_len,
+                             size_t chunk, bool crc) {
+  static DecodeEvent expected[8192];
+  static DecodeEvent actual[8192];
+  uint8_t output[512];
+  TEST_ASSERT_TRUE(output_len <= sizeof(output));
+  TEST_ASSERT_TRUE(stream_len <= ARRAY_SIZE(expected));
+
+  CobsDecodeState state;
+  if (crc) {
+    CobsDecodeStateInitCrc16(&state, output, output_len, &kCrc16KermitInfo);
+  } else {
+    CobsDecodeStateInit(&state, output, output_len);
+  }
+  size_t num_expected = 0;
+  for (size_t i = 0; i < stream_len; ++i) {
+    const CobsStatus status = CobsDecodeByte(&state, stream[i]);
+    if (status != kCobsStatusProcessing) {
+      num_expected = RecordEvent(expected, num_expected, status, &state);
+    }
+  }
+
+  if (crc) {
+    CobsDecodeStateInitCrc16(&state, output, output_len, &kCrc16KermitInfo);
+  } else {
+    CobsDecodeStateInit(&state, output, output_len);
+  }
+  size_t num_actual = 0;
+  for (size_t i = 0; i < stream_len; i += chunk) {
+    const size_t block_len = stream_len - i < chunk ? stream_len - i : chunk;
+    size_t done = 0;
+    while (done < block_len) {
+      size_t consumed;
+      const CobsStatus status = CobsDecodeBlock(&state, &stream[i + done], block_len - done,
+                                                &consumed);
+      TEST_ASSERT_TRUE(consumed > 0);
+      done += consumed;
+      if (status != kCobsStatusProcessing) {
+        num_actual = RecordEvent(actual, num_actual, status, &state);
+      } else {
+        TEST_ASSERT_EQUAL_INT32(block_len, done);
+      }
+    }
+  }
+
+  TEST_ASSERT_EQUAL_INT32(num_expected, num_actual);
+  for (size_t i = 0; i < num_expected; ++i) {
+    TEST_ASSERT_EQUAL_INT(expected[i].status, actual[i].status);
+    TEST_ASSERT_EQUAL_INT32(expected[i].len, actual[i].len);
+    TEST_ASSERT_EQUAL_HEX32(expected[i].sum, actual[i].sum);
+  }
+}
+
+static void TestCobsDecodeBlock(void) {
+  FillCrcInput();
+
+  // Valid frames of assorted lengths with and without CRCs, plus corrupted and truncated frames.
+  static uint8_t stream[8192];
+  size_t stream_len = 0;
+  const size_t frame_lens[] = {0, 1, 5, 60, 200, 254, 255, 300, 400, 700};
+  for (size_t i = 0; i < ARRAY_SIZE(frame_lens); ++i) {
+    const uint8_t *frame = &g_crc_input[i * 97];
+    stream_len += CobsEncodeBuffer(&stream[stream_len], frame, frame_lens[i]);
+
+    CobsEncodeState state;
+    CobsEncodeStateInitCrc16(&state, &stream[stream_len], &kCrc16KermitInfo);
+    CobsEncodeBlock(&state, frame, frame_lens[i], true);
+    stream_len += state.len;
+  }
+  const uint8_t malformed[] = {0x05, 0x11, 0x00, 0x03, 0x22, 0x33, 0x00, 0x00};
+  for (size_t i = 0; i < sizeof(malformed); ++i) {
+    stream[stream_len++] = malformed[i];
+  }
+  const size_t corrupt_at = stream_len / 3;
+  stream[corrupt_at] = (uint8_t)(stream[corrupt_at] + 1) ? (uint8_t)(stream[corrupt_at] + 1) : 1;
+  TEST_ASSERT_TRUE(stream_len <= sizeof(stream));
+
+  const CobsKernel original = CobsGetKernel();
+  const size_t chunks[] = {1, 2, 7, 64, 255, 1000, sizeof(stream)};
+  const size_t output_lens[] = {0, 100, 256, 512};
+  for (int kernel = 0; kernel < kNumCobsKernel; ++kernel) {
+    if (!CobsSetKernel((CobsKernel)kernel)) {
+      continue;
+    }
+    for (size_t c = 0; c < ARRAY_SIZE(chunks); ++c) {
+      for (size_t o = 0; o < ARRAY_SIZE(output_lens); ++o) {
+        CheckDecodeBlock(stream, stream_len, output_lens[o], chunks[c], false);
+        CheckDecodeBlock(stream, stream_len, output_lens[o], chunks[c], true);
+      }
+    }
+  }
+  TEST_ASSERT_TRUE(CobsSetKernel(original));
+}
+
+static void TestCobsDecodeInPlace(void) {
+  for (size_t i = 0; i < ARRAY_SIZE(g_test_vectors); ++i) {
+    Array input = g_test_vectors[i].input;
+    Array output = g_test_vectors[i].output;
+    const char *message = g_test_vectors[i].message;
+
+    uint8_t buf[output.len];
+    memcpy(buf, output.data, output.len);
+    size_t len;
+    CobsStatus status = CobsDecodeInPlace(buf, output.len, &len);
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(kCobsStatusFrameAvailable, status, message);
+    TEST_ASSERT_EQUAL_INT32_MESSAGE(input.len, len, message);
+    if (input.len) {
+      TEST_ASSERT_EQUAL_HEX8_ARRAY_MESSAGE(input.data, buf, input.len, message);
+    }
+  }
+
+  uint8_t malformed[] = {0x05, 0x11, 0x00};
+  size_t len;
+  TEST_ASSERT_EQUAL_INT(kCobsStatusMalformedFrame,
+                        CobsDecodeInPlace(malformed, sizeof(malformed), &len));
+}
+
+static void TestCobsDecodeInPlaceStream(void) {
+  // All vectors back to back.
+  uint8_t stream[4096];
+  size_t stream_len = 0;
+  for (size_t i = 0; i < ARRAY_SIZE(g_test_vectors); ++i) {
+    memcpy(&stream[stream_len], g_test_vectors[i].output.data, g_test_vectors[i].output.len);
+    stream_len += g_test_vectors[i].output.len;
+  }
+
+  const CobsKernel original = CobsGetKernel();
+  const size_t chunks[] = {1, 5, 100, 300};
+  for (int kernel = 0; kernel < kNumCobsKernel; ++kernel) {
+    if (!CobsSetKernel((CobsKernel)kernel)) {
+      continue;
+    }
+
+    for (size_t c = 0; c < ARRAY_SIZE(chunks); ++c) {
+      uint8_t buf[300];
+      CobsDecodeInPlaceState state;
+      CobsDecodeInPlaceStateInit(&state, buf, sizeof(buf));
+
+      size_t sent = 0;
+      size_t frames = 0;
+      while (sent < stream_len) {
+        size_t available;
+        uint8_t *write_ptr = CobsDecodeInPlaceWritePtr(&state, &available);
+        TEST_ASSERT_TRUE(available > 0);
+        size_t len = chunks[c] < available ? chunks[c] : available;
+        len = len < stream_len - sent ? len : stream_len - sent;
+        memcpy(write_ptr, &stream[sent], len);
+        CobsDecodeInPlaceCommit(&state, len);
+        sent += len;
+
+        uint8_t *frame;
+        size_t frame_len;
+        CobsStatus status;
+        while ((status = CobsDecodeInPlaceNext(&state, &frame, &frame_len)) !=
+               kCobsStatusProcessing) {
+          TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable, status);
+          TEST_ASSERT_TRUE(frames < ARRAY_SIZE(g_test_vectors));
+          const Array expected = g_test_vectors[frames++].input;
+          TEST_ASSERT_EQUAL_INT32(expected.len, frame_len);
+          TEST_ASSERT_TRUE(frame >= buf && frame + frame_len <= buf + sizeof(buf));
+          if (expected.len) {
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data, frame, expected.len);
+          }
+        }
+      }
+      TEST_ASSERT_EQUAL_INT32(ARRAY_SIZE(g_test_vectors), frames);
+    }
+  }
+  TEST_ASSERT_TRUE(CobsSetKernel(original));
+
+  // Frame larger than the buffer.
+  uint8_t buf[8];
+  CobsDecodeInPlaceState state;
+  CobsDecodeInPlaceStateInit(&state, buf, sizeof(buf));
+  size_t available;
+  uint8_t *write_ptr = CobsDecodeInPlaceWritePtr(&state, &available);
+  TEST_ASSERT_EQUAL_INT32(sizeof(buf), available);
+  memset(write_ptr, 0x22, available);
+  CobsDecodeInPlaceCommit(&state, available);
+  uint8_t *frame;
+  size_t frame_len;
+  TEST_ASSERT_EQUAL_INT(kCobsStatusOverflow, CobsDecodeInPlaceNext(&state, &frame, &frame_len));
+  TEST_ASSERT_NULL(frame);
+  CobsDecodeInPlaceWritePtr(&state, &available);
+  TEST_ASSERT_EQUAL_INT32(sizeof(buf), available);
+}
+
+typedef struct {
+  CobsMode mode;
+  Array input;
+  Array output;
+} ModeVector;
+
+static void CheckModeDecode(CobsMode mode, const uint8_t *encoded, size_t encoded_len,
+                            const uint8_t *expected, size_t expected_len) {
+  static uint8_t decoded[2048];
+  size_t decoded_len = sizeof(decoded);
+  TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable,
+                        CobsDecodeBufferMode(decoded, &decoded_len, encoded, encoded_len, mode));
+  TEST_ASSERT_EQUAL_INT32(expected_len, decoded_len);
+  if (expected_len) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, decoded, expected_len);
+  }
+
+  CobsDecodeState state;
+  CobsDecodeStateInit(&state, decoded, sizeof(decoded));
+  CobsDecodeStateSetMode(&state, mode);
+  for (size_t i = 0; i + 1 < encoded_len; ++i) {
+    TEST_ASSERT_EQUAL_INT(kCobsStatusProcessing, CobsDecodeByte(&state, encoded[i]));
+  }
+  TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable,
+                        CobsDecodeByte(&state, encoded[encoded_len - 1]));
+  TEST_ASSERT_EQUAL_INT32(expected_len, state.len);
+  if (expected_len) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, decoded, expected_len);
+  }
+}
+
+static void TestCobsModeVectors(void) {
+  static const uint8_t r_in_0[] = {0x11, 0x22, 0x33};
+  static const uint8_t r_out_0[] = {0x33, 0x11, 0x22, 0x00};
+  static const uint8_t r_in_1[] = {0x11, 0x22, 0x02};
+  static const uint8_t r_out_1[] = {0x04, 0x11, 0x22, 0x02, 0x00};
+  static const uint8_t r_in_2[] = {0x05};
+  static const uint8_t r_out_2[] = {0x05, 0x00};
+  static const uint8_t r_in_3[] = {0x11, 0x00};
+  static const uint8_t r_out_3[] = {0x02, 0x11, 0x01, 0x00};
+  static const uint8_t r_in_4[] = {0x00, 0x11};
+  static const uint8_t r_out_4[] = {0x01, 0x11, 0x00};
+  static const uint8_t z_in_0[] = {0x00};
+  static const uint8_t z_out_0[] = {0xE1, 0x00};
+  static const uint8_t z_in_1[] = {0x00, 0x00};
+  static const uint8_t z_out_1[] = {0xE1, 0x01, 0x00};
+  static const uint8_t z_in_2[] = {0x11, 0x00, 0x00, 0x22};
+  static const uint8_t z_out_2[] = {0xE2, 0x11, 0x02, 0x22, 0x00};
+  static const uint8_t z_in_3[] = {0x11, 0x00, 0x22};
+  static const uint8_t z_out_3[] = {0x02, 0x11, 0x02, 0x22, 0x00};
+  static const uint8_t z_in_4[] = {0x11, 0x00, 0x00, 0x00, 0x00, 0x00};
+  static const uint8_t z_out_4[] = {0xE2, 0x11, 0xE1, 0xE1, 0x00};
+  static const uint8_t empty_out[] = {0x01, 0x00};
+  const ModeVector vectors[] = {
+      {kCobsModeReduced, {NULL, 0}, {empty_out, sizeof(empty_out)}},
+      {kCobsModeReduced, {r_in_0, sizeof(r_in_0)}, {r_out_0, sizeof(r_out_0)}},
+      {kCobsModeReduced, {r_in_1, sizeof(r_in_1)}, {r_out_1, sizeof(r_out_1)}},
+      {kCobsModeReduced, {r_in_2, sizeof(r_in_2)}, {r_out_2, sizeof(r_out_2)}},
+      {kCobsModeReduced, {r_in_3, sizeof(r_in_3)}, {r_out_3, sizeof(r_out_3)}},
+      {kCobsModeReduced, {r_in_4, sizeof(r_in_4)}, {r_out_4, sizeof(r_out_4)}},
+      {kCobsModeZpe, {NULL, 0}, {empty_out, sizeof(empty_out)}},
+      {kCobsModeZpe, {z_in_0, sizeof(z_in_0)}, {z_out_0, sizeof(z_out_0)}},
+      {kCobsModeZpe, {z_in_1, sizeof(z_in_1)}, {z_out_1, sizeof(z_out_1)}},
+      {kCobsModeZpe, {z_in_2, sizeof(z_in_2)}, {z_out_2, sizeof(z_out_2)}},
+      {kCobsModeZpe, {z_in_3, sizeof(z_in_3)}, {z_out_3, sizeof(z_out_3)}},
+      {kCobsModeZpe, {z_in_4, sizeof(z_in_4)}, {z_out_4, sizeof(z_out_4)}},
+  };
+
+  for (size_t i = 0; i < ARRAY_SIZE(vectors); ++i) {
+    uint8_t actual[16];
+    const size_t actual_len =
+        CobsEncodeBufferMode(actual, vectors[i].input.data, vectors[i].input.len, vectors[i].mode);
+    TEST_ASSERT_EQUAL_INT32(vectors[i].output.len, actual_len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(vectors[i].output.data, actual, actual_len);
+    CheckModeDecode(vectors[i].mode, actual, actual_len, vectors[i].input.data,
+                    vectors[i].input.len);
+  }
+
+  // Group limits.
+  static uint8_t input[260];
+  static uint8_t encoded[COBS_ZPE_MAX_ENCODE_LEN(sizeof(input))];
+  memset(input, 0x5A, sizeof(input));
+  input[30] = input[31] = 0x00;
+  TEST_ASSERT_EQUAL_INT32(33, CobsEncodeBufferMode(encoded, input, 32, kCobsModeZpe));
+  TEST_ASSERT_EQUAL_HEX8(0xFF, encoded[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x01, encoded[31]);
+  memset(input, 0x5A, sizeof(input));
+  TEST_ASSERT_EQUAL_INT32(225, CobsEncodeBufferMode(encoded, input, 223, kCobsModeZpe));
+  TEST_ASSERT_EQUAL_HEX8(0xE0, encoded[0]);
+  TEST_ASSERT_EQUAL_INT32(227, CobsEncodeBufferMode(encoded, input, 224, kCobsModeZpe));
+  TEST_ASSERT_EQUAL_HEX8(0xE0, encoded[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x02, encoded[224]);
+  CheckModeDecode(kCobsModeZpe, encoded, 227, input, 224);
+  input[222] = 0x00;
+  TEST_ASSERT_EQUAL_INT32(225, CobsEncodeBufferMode(encoded, input, 223, kCobsModeZpe));
+  TEST_ASSERT_EQUAL_HEX8(0xDF, encoded[0]);
+  CheckModeDecode(kCobsModeZpe, encoded, 225, input, 223);
+
+  // COBS/R frames ending early are malformed COBS.
+  size_t decoded_len = sizeof(input);
+  TEST_ASSERT_EQUAL_INT(kCobsStatusMalformedFrame,
+                        CobsDecodeBuffer(input, &decoded_len, r_out_0, sizeof(r_out_0)));
+  decoded_len = sizeof(input);
+  TEST_ASSERT_EQUAL_INT(kCobsStatusMalformedFrame,
+                        CobsDecodeBufferMode(input, &decoded_len, r_out_0, sizeof(r_out_0),
+                                             kCobsModeZpe));
+}
+
+// Round trip pseudo random frames of every zero density through each mode, kernel, block size and
+// decoder, checking the length bounds.
+static void TestCobsModesRoundTrip(void) {
+  const CobsKernel original = CobsGetKernel();
+  static uint8_t input[700];
+  static uint8_t encoded[COBS_ZPE_MAX_ENCODE_LEN(sizeof(input)) + 4];
+  static uint8_t decoded[sizeof(input) + 1];
+  uint32_t seed = 1;
+
+  for (int kernel = 0; kernel < kNumCobsKernel; ++kernel) {
+    if (!CobsSetKernel((CobsKernel)kernel)) {
+      continue;
+    }
+    for (int mode = 0; mode < kNumCobsMode; ++mode) {
+      for (size_t len = 0; len <= sizeof(input); len += 7) {
+        for (uint32_t zero_odds = 1; zero_odds <= 1024; zero_odds *= 4) {
+          for (size_t i = 0; i < len; ++i) {
+            seed = seed * 1103515245 + 12345;
+            input[i] = (seed >> 8) % zero_odds ? (uint8_t)(seed >> 16) | 1 : 0;
+          }
+
+          CobsEncodeState encode;
+          CobsEncodeStateInit(&encode, encoded);
+          CobsEncodeStateSetMode(&encode, (CobsMode)mode);
+          const size_t block_size = len % 5 ? len % 97 + 1 : sizeof(input);
+          size_t j = 0;
+          for (; j + block_size < len; j += block_size) {
+            CobsEncodeBlock(&encode, &input[j], block_size, false);
+          }
+          CobsEncodeBlock(&encode, &input[j], len - j, true);
+          const size_t encoded_len = encode.len;
+
+          TEST_ASSERT_TRUE(encoded_len <= (mode == kCobsModeZpe ? COBS_ZPE_MAX_ENCODE_LEN(len)
+                                                                : COBS_R_MAX_ENCODE_LEN(len)));
+          TEST_ASSERT_TRUE(len <= (mode == kCobsModeZpe ? COBS_ZPE_MAX_DECODE_LEN(encoded_len)
+                                   : mode == kCobsModeReduced ? COBS_R_MAX_DECODE_LEN(encoded_len)
+                                                              : COBS_MAX_DECODE_LEN(encoded_len)));
+          TEST_ASSERT_EQUAL_INT32(encoded_len - 1, CobsFindDelimiter(encoded, encoded_len));
+          CheckModeDecode((CobsMode)mode, encoded, encoded_len, input, len);
+
+          // Block decoding one frame after another.
+          CobsDecodeState decode;
+          CobsDecodeStateInit(&decode, decoded, sizeof(decoded));
+          CobsDecodeStateSetMode(&decode, (CobsMode)mode);
+          for (int frame = 0; frame < 2; ++frame) {
+            size_t consumed;
+            TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable,
+                                  CobsDecodeBlock(&decode, encoded, encoded_len, &consumed));
+            TEST_ASSERT_EQUAL_INT32(encoded_len, consumed);
+            TEST_ASSERT_EQUAL_INT32(len, decode.len);
+            if (len) {
+              TEST_ASSERT_EQUAL_HEX8_ARRAY(input, decoded, len);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  TEST_ASSERT_TRUE(CobsSetKernel(original));
+}
+
+static void TestCobsModesCrc(void) {
+  const uint8_t input[] = {0x11, 0x00, 0x00, 0x22, 0x33};
+  uint8_t encoded[COBS_ZPE_MAX_ENCODE_LEN(sizeof(input) + 2)];
+  uint8_t decoded[sizeof(input) + 2];
+
+  for (int mode = 0; mode < kNumCobsMode; ++mode) {
+    CobsEncodeState encode;
+    CobsEncodeStateInitCrc16(&encode, encoded, &kCrc16KermitInfo);
+    CobsEncodeStateSetMode(&encode, (CobsMode)mode);
+    CobsEncodeBlock(&encode, input, sizeof(input), true);
+
+    CobsDecodeState decode;
+    CobsDecodeStateInitCrc16(&decode, decoded, sizeof(decoded), &kCrc16KermitInfo);
+    CobsDecodeStateSetMode(&decode, (CobsMode)mode);
+    size_t consumed;
+    TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable,
+                          CobsDecodeBlock(&decode, encoded, encode.len, &consumed));
+    TEST_ASSERT_EQUAL_INT32(sizeof(input), decode.len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(input, decoded, sizeof(input));
+
+    encoded[1] ^= 0x01;
+    TEST_ASSERT_EQUAL_INT(kCobsStatusCrcError,
+                          CobsDecodeBlock(&decode, encoded, encode.len, &consumed));
+  }
+}
+
+static void TestCobsKernels(void) {
+  const CobsKernel original = CobsGetKernel();
+  TEST_ASSERT_TRUE(CobsKernelSupported(original));
+  TEST_ASSERT_TRUE(CobsKernelSupported(kCobsKernelScalar));
+  TEST_ASSERT_FALSE(CobsKernelSupported(kNumCobsKernel));
+  TEST_ASSERT_FALSE(CobsSetKernel(kNumCobsKernel));
+  TEST_ASSERT_EQUAL_INT(original, CobsGetKernel());
+
+  for (int kernel = 0; kernel < kNumCobsKernel; ++kernel) {
+    TEST_ASSERT_NOT_NULL(CobsKernelName((CobsKernel)kernel));
+    if (!CobsSetKernel((CobsKernel)kernel)) {
+      continue;
+    }
+    TEST_ASSERT_EQUAL_INT(kernel, CobsGetKernel());
+
+    TestCobsEncodeBuffer();
+    TestCobsEncodeBlock();
+    TestCobsDecodeBuffer();
+    TestCobsEncodeCrc();
+  }
+
+  TEST_ASSERT_TRUE(CobsSetKernel(original));
+}
+
+// Exercise run lengths around the vector widths and the 254 byte run limit against the scalar
+// kernel.
+static void TestCobsKernelsRuns(void) {
+  const CobsKernel original = CobsGetKernel();
+  static uint8_t input[600];
+  static uint8_t expected[COBS_MAX_ENCODE_LEN(sizeof(input))];
+  static uint8_t actual[COBS_MAX_ENCODE_LEN(sizeof(input))];
+  static uint8_t decoded[sizeof(input)];
+
+  const size_t spacings[] = {1, 2, 15, 16, 17, 31, 32, 33, 64, 253, 254, 255, 1000};
+  for (size_t s = 0; s < ARRAY_SIZE(spacings); ++s) {
+    for (size_t len = 0; len <= sizeof(input); len += 37) {
+      for (size_t i = 0; i < len; ++i) {
+        input[i] = (i + 1) % spacings[s] ? (uint8_t)(i * 7 + 1) | 1 : 0;
+      }
+
+      TEST_ASSERT_TRUE(CobsSetKernel(kCobsKernelScalar));
+      const size_t expected_len = CobsEncodeBuffer(expected, input, len);
+
+      for (int kernel = 0; kernel < kNumCobsKernel; ++kernel) {
+        if (!CobsSetKernel((CobsKernel)kernel)) {
+          continue;
+        }
+        const size_t actual_len = CobsEncodeBuffer(actual, input, len);
+        TEST_ASSERT_EQUAL_INT32(expected_len, actual_len);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, actual, expected_len);
+
+        size_t decoded_len = sizeof(decoded);
+        TEST_ASSERT_EQUAL_INT(kCobsStatusFrameAvailable,
+                              CobsDecodeBuffer(decoded, &decoded_len, actual, actual_len));
+        TEST_ASSERT_EQUAL_INT32(len, decoded_len);
+        if (len) {
+          TEST_ASSERT_EQUAL_HEX8_ARRAY(input, decoded, len);
+        }
+      }
+    }
+  }
+
+  TEST_ASSERT_TRUE(CobsSetKernel(original));
+}
+
+static void TestCobsEncodedLen(void) {
+  const CobsKernel original = CobsGetKernel();
+  static uint8_t input[600];
+  static uint8_t encoded[COBS_MAX_ENCODE_LEN(sizeof(input))];
+
+  // Every length around full 254 byte groups, ending on and off a delimiter.
+  const size_t spacings[] = {1, 2, 17, 253, 254, 255, 508, 1000};
+  for (int kernel = 0; kernel < kNumCobsKernel; ++kernel) {
+    if (!CobsSetKernel((CobsKernel)kernel)) {
+      continue;
+    }
+    for (size_t s = 0; s < ARRAY_SIZE(spacings); ++s) {
+      for (size_t len = 0; len <= sizeof(input); ++len) {
+        for (size_t i = 0; i < len; ++i) {
+          input[i] = (i + 1) % spacings[s] ? 0x5A : 0;
+        }
+        TEST_ASSERT_EQUAL_INT32(CobsEncodeBuffer(encoded, input, len), CobsEncodedLen(input, len));
+      }
+    }
+  }
+
+  TEST_ASSERT_TRUE(CobsSetKernel(original));
+}
+
+static void TestCobsFindDelimiter(void) {
+  const CobsKernel original = CobsGetKernel();
+  static uint8_t input[300];
+  memset(input, 0x5A, sizeof(input));
+
+  for (int kernel = 0; kernel < kNumCobsKernel; ++kernel) {
+    if (!CobsSetKernel((CobsKernel)kernel)) {
+      continue;
+    }
+    TEST_ASSERT_EQUAL_INT32(sizeof(input), CobsFindDelimiter(input, sizeof(input)));
+    TEST_ASSERT_EQUAL_INT32(0, CobsFindDelimiter(input, 0));
+    for (size_t i = 0; i < sizeof(input); i += 13) {
+      input[i] = 0x00;
+      TEST_ASSERT_EQUAL_INT32(i, CobsFindDelimiter(input, sizeof(input)));
+      TEST_ASSERT_EQUAL_INT32(i, CobsFindDelimiter(input, i));
+      input[i] = 0x5A;
+    }
+  }
+
+  TEST_ASSERT_TRUE(CobsSetKernel(original));
+}
+
+static void TestCobsAutotune(void) {
+  const CobsKernel original = CobsGetKernel();
+  const CobsKernel kernel = CobsAutotune();
+  TEST_ASSERT_TRUE(CobsKernelSupported(kernel));
+  TEST_ASSERT_EQUAL_INT(kernel, CobsGetKernel());
+  TEST_ASSERT_TRUE(CobsSetKernel(original));
+}
+
 int main(void) {
   UNITY_BEGIN();
   RUN_TEST(TestCobsMaxEncodeLen);
+  RUN_TEST(TestCobsEncodeHeadroom);
   RUN_TEST(TestCobsMaxDecodeLen);
   RUN_TEST(TestCobsEncodeBuffer);
   RUN_TEST(TestCobsEncodeBlock);
+  RUN_TEST(TestCobsEncodeInPlace);
+  RUN_TEST(TestCobsEncodeIov);
+  RUN_TEST(TestCobsStreamEncodeBlock);
   RUN_TEST(TestCobsDecodeBuffer);
   RUN_TEST(TestCobsDecodeByte);
+  RUN_TEST(TestCobsEncodeCrc);
+  RUN_TEST(TestCobsDecodeCrc);
+  RUN_TEST(TestCobsDecodeBlock);
+  RUN_TEST(TestCobsDecodeInPlace);
+  RUN_TEST(TestCobsDecodeInPlaceStream);
+  RUN_TEST(TestCobsModeVectors);
+  RUN_TEST(TestCobsModesRoundTrip);
+  RUN_TEST(TestCobsModesCrc);
+  RUN_TEST(TestCobsKernels);
+  RUN_TEST(TestCobsKernelsRuns);
+  RUN_TEST(TestCobsEncodedLen);
+  RUN_TEST(TestCobsFindDelimiter);
+  RUN_TEST(TestCobsAutotune);
   return UNITY_END();
 }
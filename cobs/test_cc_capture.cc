@@ -0,0 +1,139 @@
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "cobs/cc_capture.h"
+#include "cobs/cc_cobs.h"
+
+extern "C" {
+#include "crc/all_crcs.h"
+}
+
+using namespace testing;
+using namespace cobs;
+
+using FrameRange = std::pair<size_t, size_t>;
+
+class CaptureFixture : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Bazel gives each test a writable TEST_TMPDIR.
+    const char* tmpdir = std::getenv("TEST_TMPDIR");
+    std::string path = std::string(tmpdir ? tmpdir : "/tmp") + "/test_cc_capture_XXXXXX";
+    const int fd = mkstemp(path.data());
+    ASSERT_GE(fd, 0);
+    close(fd);
+    path_ = path;
+    index_path_ = path_ + ".idx";
+  }
+
+  void TearDown() override {
+    std::remove(path_.c_str());
+    std::remove(index_path_.c_str());
+  }
+
+  void Write(const std::vector<uint8_t>& data) {
+    FILE* file = std::fopen(path_.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(std::fwrite(data.data(), 1, data.size(), file), data.size());
+    std::fclose(file);
+  }
+
+  std::string path_;
+  std::string index_path_;
+};
+
+TEST_F(CaptureFixture, Index) {
+  std::vector<std::vector<uint8_t>> payloads;
+  std::vector<uint8_t> data;
+  for (size_t i = 0; i < 500; ++i) {
+    std::vector<uint8_t> payload(i % 300);
+    for (size_t j = 0; j < payload.size(); ++j) {
+      payload[j] = static_cast<uint8_t>(i * 31 + j * 7);
+    }
+    const auto encoded = Encode(payload.data(), payload.size());
+    data.insert(data.end(), encoded.begin(), encoded.end());
+    payloads.push_back(payload);
+  }
+  data.push_back(0x05);  // Trailing partial frame.
+  Write(data);
+
+  Capture capture;
+  ASSERT_TRUE(capture.Open(path_));
+  EXPECT_EQ(capture.Size(), data.size());
+  EXPECT_FALSE(capture.LoadIndex(index_path_));
+  capture.BuildIndex();
+  ASSERT_EQ(capture.NumFrames(), payloads.size() + 1);
+
+  for (size_t n = 0; n < payloads.size(); ++n) {
+    auto [status, decoded] = capture.Decode(n);
+    EXPECT_EQ(status, Status::FrameAvailable);
+    EXPECT_EQ(decoded, payloads[n]);
+  }
+  EXPECT_EQ(capture.Decode(payloads.size()).first, Status::IncompleteFrame);
+
+  // Byte ranges.
+  EXPECT_EQ(capture.FramesInRange(0, 1), FrameRange(0, 1));
+  EXPECT_EQ(capture.FramesInRange(1, capture.Offset(3) + 1), FrameRange(1, 4));
+  EXPECT_EQ(capture.FramesInRange(0, data.size()), FrameRange(0, 501));
+  EXPECT_EQ(capture.FramesInRange(data.size(), data.size() + 10),
+            FrameRange(501, 501));
+
+  // Sidecar.
+  ASSERT_TRUE(capture.SaveIndex(index_path_));
+  Capture reopened;
+  ASSERT_TRUE(reopened.Open(path_));
+  ASSERT_TRUE(reopened.LoadIndex(index_path_));
+  ASSERT_EQ(reopened.NumFrames(), capture.NumFrames());
+  for (size_t n = 0; n < capture.NumFrames(); ++n) {
+    EXPECT_EQ(reopened.Encoded(n), std::make_pair(reopened.Data() + capture.Offset(n),
+                                                  capture.Encoded(n).second));
+  }
+
+  // Stale once the capture changes.
+  data.push_back(0x00);
+  Write(data);
+  ASSERT_TRUE(reopened.Open(path_));
+  EXPECT_FALSE(reopened.LoadIndex(index_path_));
+}
+
+TEST_F(CaptureFixture, CrcStatus) {
+  CrcEncoder<16> encoder(&kCrc16KermitInfo, 64);
+  std::vector<uint8_t> data;
+  for (int i = 0; i < 10; ++i) {
+    const uint8_t payload[] = {static_cast<uint8_t>(i), 0x00, 0x22};
+    encoder.Encode(payload, sizeof(payload));
+    auto encoded = encoder.GetCopy();
+    if (i == 3) {
+      encoded[1] ^= 0x40;
+    }
+    data.insert(data.end(), encoded.begin(), encoded.end());
+  }
+  Write(data);
+
+  Capture capture;
+  ASSERT_TRUE(capture.Open(path_));
+  capture.BuildIndex<16>(&kCrc16KermitInfo);
+  EXPECT_TRUE(capture.HasCrcStatus<16>(&kCrc16KermitInfo));
+  EXPECT_FALSE(capture.HasCrcStatus<16>(&kCrc16CcittFalseInfo));
+  ASSERT_EQ(capture.NumFrames(), 10);
+  for (size_t n = 0; n < 10; ++n) {
+    EXPECT_EQ(capture.CrcStatus(n), n == 3 ? Status::CrcError : Status::FrameAvailable);
+  }
+
+  ASSERT_TRUE(capture.SaveIndex(index_path_));
+  Capture reopened;
+  ASSERT_TRUE(reopened.Open(path_));
+  ASSERT_TRUE(reopened.LoadIndex(index_path_));
+  EXPECT_TRUE(reopened.HasCrcStatus<16>(&kCrc16KermitInfo));
+  EXPECT_EQ(reopened.CrcStatus(3), Status::CrcError);
+  EXPECT_EQ(reopened.CrcStatus(4), Status::FrameAvailable);
+}
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -5,6 +9,11 @@
 #include <gtest/gtest.h>
 
 #include "cobs/cc_cobs.h"
+#include "util/cc_spsc_ring.h"
+
+extern "C" {
+#include "crc/all_crcs.h"
+}
 
 using namespace testing;
 using namespace cobs;
@@ -157,6 +166,161 @@ TEST_F(TestVectorFixture, EncoderSuccess) {
   }
 }
 
+TEST_F(TestVectorFixture, EncodeInPlace) {
+  for (size_t i = 0; i < vectors_.size(); ++i) {
+    SCOPED_TRACE("Vector: " + std::to_string(i));
+    auto& [decoded, encoded] = vectors_[i];
+
+    const size_t headroom = EncodeHeadroom(decoded.size());
+    std::vector<uint8_t> buf(headroom);
+    buf.insert(buf.end(), decoded.begin(), decoded.end());
+
+    const size_t len = EncodeInPlace(buf.data(), headroom, decoded.size());
+
+    buf.resize(len);
+    EXPECT_THAT(buf, ElementsAreArray(encoded));
+  }
+}
+
+TEST_F(TestVectorFixture, EncoderInPlace) {
+  constexpr size_t kMaxPayload = 300;
+  std::vector<uint8_t> buf(EncodeHeadroom(kMaxPayload) + kMaxPayload);
+  Encoder encoder(InPlace{}, buf.data(), kMaxPayload);
+  ASSERT_EQ(encoder.Payload(), buf.data() + EncodeHeadroom(kMaxPayload));
+
+  for (size_t i = 0; i < vectors_.size(); ++i) {
+    SCOPED_TRACE("Vector: " + std::to_string(i));
+    auto& [decoded, encoded] = vectors_[i];
+
+    uint8_t* payload = encoder.Payload();
+    std::copy(decoded.begin(), decoded.end(), payload);
+    constexpr size_t kBlockSize = 25;
+    for (size_t j = 0; j < decoded.size(); j += kBlockSize) {
+      encoder.Encode(payload + j, std::min(kBlockSize, decoded.size() - j));
+    }
+
+    auto [actual_ptr, actual_len] = encoder.Get();
+    EXPECT_EQ(actual_ptr, buf.data());
+    std::vector<uint8_t> actual{actual_ptr, actual_ptr + actual_len};
+    EXPECT_THAT(actual, ElementsAreArray(encoded));
+  }
+}
+
+TEST_F(TestVectorFixture, EncoderSegments) {
+  Encoder encoder(1024);
+  for (size_t i = 0; i < vectors_.size(); ++i) {
+    SCOPED_TRACE("Vector: " + std::to_string(i));
+    auto& [decoded, encoded] = vectors_[i];
+
+    const size_t third = decoded.size() / 3;
+    encoder.Encode({{decoded.data(), third},
+                    {decoded.data() + third, third},
+                    {decoded.data() + 2 * third, decoded.size() - 2 * third}});
+
+    EXPECT_THAT(encoder.GetCopy(), ElementsAreArray(encoded));
+  }
+}
+
+TEST_F(TestVectorFixture, StreamEncoder) {
+  std::vector<uint8_t> output;
+  size_t max_write = 0;
+  StreamEncoder encoder([&](const uint8_t* data, size_t len) {
+    output.insert(output.end(), data, data + len);
+    max_write = std::max(max_write, len);
+  });
+
+  for (size_t i = 0; i < vectors_.size(); ++i) {
+    SCOPED_TRACE("Vector: " + std::to_string(i));
+    auto& [decoded, encoded] = vectors_[i];
+
+    output.clear();
+    constexpr size_t kBlockSize = 25;
+    for (size_t j = 0; j < decoded.size(); j += kBlockSize) {
+      encoder.Encode(decoded.data() + j, std::min(kBlockSize, decoded.size() - j));
+    }
+    encoder.Finish();
+    EXPECT_THAT(output, ElementsAreArray(encoded));
+  }
+
+  // Long frames are passed on a group at a time.
+  std::vector<uint8_t> frame(5000, 0x5A);
+  frame[1000] = 0x00;
+  output.clear();
+  max_write = 0;
+  encoder.Encode(frame.data(), frame.size());
+  EXPECT_GE(output.size(), frame.size() - 254);
+  encoder.Finish();
+  EXPECT_EQ(output, Encode(frame.data(), frame.size()));
+  EXPECT_EQ(max_write, 255);
+}
+
+TEST_F(TestVectorFixture, EncodeToIov) {
+  for (size_t i = 0; i < vectors_.size(); ++i) {
+    SCOPED_TRACE("Vector: " + std::to_string(i));
+    auto& [decoded, encoded] = vectors_[i];
+
+    const size_t half = decoded.size() / 2;
+    const iovec iov[] = {{decoded.data(), half}, {decoded.data() + half, decoded.size() - half}};
+    std::vector<uint8_t> scratch(MaxEncodeLen(decoded.size()));
+    std::vector<iovec> out(COBS_MAX_IOV_OUT(decoded.size()));
+
+    auto [out_cnt, encoded_len] = EncodeToIov(iov, 2, scratch.data(), out.data());
+
+    std::vector<uint8_t> actual;
+    for (int j = 0; j < out_cnt; ++j) {
+      const uint8_t* base = static_cast<const uint8_t*>(out[static_cast<size_t>(j)].iov_base);
+      actual.insert(actual.end(), base, base + out[static_cast<size_t>(j)].iov_len);
+    }
+    EXPECT_EQ(encoded_len, encoded.size());
+    EXPECT_THAT(actual, ElementsAreArray(encoded));
+  }
+}
+
+template <int N>
+static void TestCrcEncoderSuccess(CrcEncoder<N>& encoder, const typename crc::Crc<N>::Info* info,
+                                  const Vectors& vectors) {
+  for (size_t i = 0; i < vectors.size(); ++i) {
+    SCOPED_TRACE("Vector: " + std::to_string(i));
+    auto& [decoded, encoded] = vectors[i];
+
+    encoder.Reset();
+    const size_t half = decoded.size() / 2;
+    encoder.Encode(decoded.data(), half);
+    encoder.Encode(decoded.data() + half, decoded.size() - half);
+    std::vector<uint8_t> frame = encoder.GetCopy();
+
+    // Frame decodes to the payload followed by its CRC in transmission order.
+    std::vector<uint8_t> expected = decoded;
+    const uint32_t value = crc::Crc<N>::Block(info, decoded.data(), decoded.size());
+    for (size_t j = 0; j < CrcEncoder<N>::kCrcLen; ++j) {
+      const size_t byte = info->lsb_first ? j : CrcEncoder<N>::kCrcLen - 1 - j;
+      expected.push_back(static_cast<uint8_t>(value >> (8 * byte)));
+    }
+
+    auto [status, actual] = Decode(frame.data(), frame.size());
+    ASSERT_EQ(status, Status::FrameAvailable);
+    EXPECT_THAT(actual, ElementsAreArray(expected));
+  }
+}
+
+TEST_F(TestVectorFixture, CrcEncoderSuccess) {
+  {
+    std::vector<uint8_t> buf(1024);
+    CrcEncoder<32> encoder(&kCrc32Info, buf.data());
+    TestCrcEncoderSuccess(encoder, &kCrc32Info, vectors_);
+  }
+  {
+    CrcEncoder<16> encoder(&kCrc16CcittFalseInfo, 1024);
+    TestCrcEncoderSuccess(encoder, &kCrc16CcittFalseInfo, vectors_);
+  }
+  {
+    CrcEncoder<8> encoder(&kCrc8DarcInfo, 1024);
+    auto [ptr, len] = encoder.Get();
+    std::vector<uint8_t> frame(ptr, ptr + len);
+    EXPECT_THAT(frame, ElementsAre(0x01, 0x01, 0x00));
+  }
+}
+
 static void TestDecoderSuccess(Decoder& decoder, const Vectors& vectors) {
   for (size_t i = 0; i < vectors.size(); ++i) {
     SCOPED_TRACE("Vector: " + std::to_string(i));
@@ -246,6 +410,12 @@ static void TestDecoderOverflow(Decoder& decoder, size_t len) {
   }
 }
 
+TEST(Status, Name) {
+  EXPECT_STREQ(StatusName(Status::FrameAvailable), "ok");
+  EXPECT_STREQ(StatusName(Status::CrcError), "crc_error");
+  EXPECT_STREQ(StatusName(static_cast<Status>(-1)), "unknown");
+}
+
 TEST(Decoder, Overflow) {
   constexpr size_t kLen = 3;
   {
@@ -361,6 +531,15 @@ TEST(MaxLengths, Encode) {
   EXPECT_EQ(513, MaxEncodeLen(509));
 }
 
+TEST(MaxLengths, EncodeHeadroom) {
+  EXPECT_EQ(2, EncodeHeadroom(0));
+  EXPECT_EQ(2, EncodeHeadroom(1));
+  EXPECT_EQ(2, EncodeHeadroom(254));
+  EXPECT_EQ(3, EncodeHeadroom(255));
+  EXPECT_EQ(3, EncodeHeadroom(508));
+  EXPECT_EQ(4, EncodeHeadroom(509));
+}
+
 TEST(MaxLengths, Decode) {
   EXPECT_EQ(0, MaxDecodeLen(0));
   EXPECT_EQ(0, MaxDecodeLen(1));
@@ -368,3 +547,379 @@ TEST(MaxLengths, Decode) {
   EXPECT_EQ(1, MaxDecodeLen(3));
   EXPECT_EQ(1000, MaxDecodeLen(1002));
 }
+
+TEST(MaxLengths, Modes) {
+  EXPECT_EQ(MaxEncodeLen(0, Mode::Reduced), MaxEncodeLen(0));
+  EXPECT_EQ(MaxEncodeLen(1000, Mode::Reduced), MaxEncodeLen(1000));
+  EXPECT_EQ(2, MaxEncodeLen(0, Mode::Zpe));
+  EXPECT_EQ(225, MaxEncodeLen(223, Mode::Zpe));
+  EXPECT_EQ(227, MaxEncodeLen(224, Mode::Zpe));
+  EXPECT_EQ(1001, MaxDecodeLen(1002, Mode::Reduced));
+  EXPECT_EQ(0, MaxDecodeLen(1, Mode::Zpe));
+  EXPECT_EQ(1, MaxDecodeLen(2, Mode::Zpe));
+  EXPECT_EQ(5, MaxDecodeLen(4, Mode::Zpe));
+}
+
+// Telemetry record of zero padded fields.
+static std::vector<uint8_t> MakeTelemetry(size_t records) {
+  std::vector<uint8_t> telemetry;
+  for (size_t i = 0; i < records; ++i) {
+    const uint8_t record[] = {0x01, 0x00, 0x00, 0x00, static_cast<uint8_t>(i), 0x00, 0x00, 0x00,
+                              0x2A, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    telemetry.insert(telemetry.end(), std::begin(record), std::end(record));
+  }
+  return telemetry;
+}
+
+TEST_F(TestVectorFixture, Modes) {
+  vectors_.push_back({MakeTelemetry(40), {}});
+  for (Mode mode : {Mode::Standard, Mode::Reduced, Mode::Zpe}) {
+    SCOPED_TRACE("Mode: " + std::to_string(static_cast<int>(mode)));
+    Encoder encoder(2048);
+    encoder.SetMode(mode);
+    Decoder decoder(2048);
+    decoder.SetMode(mode);
+
+    for (size_t i = 0; i < vectors_.size(); ++i) {
+      SCOPED_TRACE("Vector: " + std::to_string(i));
+      const std::vector<uint8_t>& decoded = vectors_[i].first;
+
+      const std::vector<uint8_t> encoded = Encode(decoded.data(), decoded.size(), mode);
+      EXPECT_LE(encoded.size(), MaxEncodeLen(decoded.size(), mode));
+      if (mode == Mode::Standard) {
+        EXPECT_EQ(encoded, Encode(decoded.data(), decoded.size()));
+      }
+      EXPECT_THAT(Decode(encoded.data(), encoded.size(), mode),
+                  Pair(Status::FrameAvailable, ElementsAreArray(decoded)));
+
+      // The mode persists across frames.
+      for (int frame = 0; frame < 2; ++frame) {
+        encoder.Encode(decoded.data(), decoded.size());
+        EXPECT_EQ(encoder.GetCopy(), encoded);
+
+        size_t consumed;
+        auto [status, span] = decoder.Decode(encoded.data(), encoded.size(), &consumed);
+        EXPECT_EQ(status, Status::FrameAvailable);
+        EXPECT_EQ(consumed, encoded.size());
+        EXPECT_THAT(std::vector<uint8_t>(span.first, span.first + span.second),
+                    ElementsAreArray(decoded));
+      }
+    }
+  }
+}
+
+TEST(Modes, Overhead) {
+  const std::vector<uint8_t> telemetry = MakeTelemetry(40);
+  const size_t standard = Encode(telemetry.data(), telemetry.size()).size();
+  const size_t reduced = Encode(telemetry.data(), telemetry.size(), Mode::Reduced).size();
+  const size_t zpe = Encode(telemetry.data(), telemetry.size(), Mode::Zpe).size();
+  EXPECT_LE(reduced, standard);
+  EXPECT_LT(zpe, standard * 3 / 4);
+
+  // COBS/R saves the code byte when the final data byte is large enough.
+  const uint8_t frame[] = {0x11, 0x22, 0x33};
+  EXPECT_EQ(Encode(frame, sizeof(frame), Mode::Reduced).size(), sizeof(frame) + 1);
+}
+
+TEST(Modes, Crc) {
+  const std::vector<uint8_t> telemetry = MakeTelemetry(10);
+  for (Mode mode : {Mode::Reduced, Mode::Zpe}) {
+    CrcEncoder<16> encoder(&kCrc16KermitInfo, 1024);
+    encoder.SetMode(mode);
+    CrcDecoder<16> decoder(&kCrc16KermitInfo, 1024);
+    decoder.SetMode(mode);
+
+    encoder.Encode(telemetry.data(), telemetry.size());
+    std::vector<uint8_t> encoded = encoder.GetCopy();
+    size_t consumed;
+    auto [status, span] = decoder.Decode(encoded.data(), encoded.size(), &consumed);
+    EXPECT_EQ(status, Status::FrameAvailable);
+    EXPECT_THAT(std::vector<uint8_t>(span.first, span.first + span.second),
+                ElementsAreArray(telemetry));
+
+    *std::find(encoded.begin(), encoded.end(), 0x2A) ^= 0x01;
+    EXPECT_EQ(decoder.Decode(encoded.data(), encoded.size(), &consumed).first, Status::CrcError);
+  }
+}
+
+TEST_F(TestVectorFixture, CrcDecoderSuccess) {
+  CrcEncoder<32> encoder(&kCrc32Info, 1024);
+  CrcDecoder<32> decoder(&kCrc32Info, 1024);
+  for (size_t i = 0; i < vectors_.size(); ++i) {
+    SCOPED_TRACE("Vector: " + std::to_string(i));
+    auto& decoded = vectors_[i].first;
+
+    encoder.Encode(decoded.data(), decoded.size());
+    std::vector<uint8_t> frame = encoder.GetCopy();
+
+    for (size_t j = 0; j + 1 < frame.size(); ++j) {
+      EXPECT_EQ(Status::Processing, decoder.Decode(frame[j]).first);
+    }
+    auto [status, actual] = decoder.DecodeAndCopy(frame.back());
+    ASSERT_EQ(status, Status::FrameAvailable);
+    EXPECT_THAT(actual, ElementsAreArray(decoded));
+  }
+}
+
+TEST(CrcDecoder, CrcError) {
+  CrcDecoder<16> decoder(&kCrc16KermitInfo, 16);
+  // Payload {0x11} with a wrong CRC.
+  const std::vector<uint8_t> frame = {0x04, 0x11, 0x22, 0x33, 0x00};
+  for (size_t i = 0; i + 1 < frame.size(); ++i) {
+    EXPECT_EQ(Status::Processing, decoder.Decode(frame[i]).first);
+  }
+  EXPECT_EQ(Status::CrcError, decoder.Decode(frame.back()).first);
+}
+
+TEST_F(TestVectorFixture, DecoderBlock) {
+  // All vectors back to back, fed in odd sized chunks.
+  std::vector<uint8_t> stream;
+  for (auto& [decoded, encoded] : vectors_) {
+    stream.insert(stream.end(), encoded.begin(), encoded.end());
+  }
+
+  for (size_t chunk : {1u, 3u, 100u, 10000u}) {
+    SCOPED_TRACE("Chunk: " + std::to_string(chunk));
+    Decoder decoder(1024);
+    size_t frame = 0;
+    for (size_t i = 0; i < stream.size(); i += chunk) {
+      const uint8_t* input = stream.data() + i;
+      size_t len = std::min(chunk, stream.size() - i);
+      while (len > 0) {
+        size_t consumed = 0;
+        auto [status, span] = decoder.Decode(input, len, &consumed);
+        input += consumed;
+        len -= consumed;
+        if (status == Status::Processing) {
+          EXPECT_EQ(len, 0);
+          continue;
+        }
+        ASSERT_EQ(status, Status::FrameAvailable);
+        ASSERT_LT(frame, vectors_.size());
+        std::vector<uint8_t> actual{span.first, span.first + span.second};
+        EXPECT_THAT(actual, ElementsAreArray(vectors_[frame++].first));
+      }
+    }
+    EXPECT_EQ(frame, vectors_.size());
+  }
+}
+
+TEST_F(TestVectorFixture, DecodeInPlace) {
+  for (size_t i = 0; i < vectors_.size(); ++i) {
+    SCOPED_TRACE("Vector: " + std::to_string(i));
+    auto [decoded, encoded] = vectors_[i];
+
+    auto [status, span] = DecodeInPlace(encoded.data(), encoded.size());
+
+    EXPECT_EQ(status, Status::FrameAvailable);
+    EXPECT_EQ(span.first, encoded.data());
+    std::vector<uint8_t> actual{span.first, span.first + span.second};
+    EXPECT_THAT(actual, ElementsAreArray(decoded));
+  }
+}
+
+TEST_F(TestVectorFixture, InPlaceDecoder) {
+  std::vector<uint8_t> stream;
+  for (auto& [decoded, encoded] : vectors_) {
+    stream.insert(stream.end(), encoded.begin(), encoded.end());
+  }
+
+  for (size_t chunk : {1u, 3u, 100u, 10000u}) {
+    SCOPED_TRACE("Chunk: " + std::to_string(chunk));
+    InPlaceDecoder decoder(300);
+    size_t frame = 0;
+    for (size_t i = 0; i < stream.size();) {
+      auto [write_ptr, available] = decoder.WritePtr();
+      ASSERT_GT(available, 0);
+      const size_t len = std::min({chunk, available, stream.size() - i});
+      std::copy_n(stream.data() + i, len, write_ptr);
+      decoder.Commit(len);
+      i += len;
+
+      for (auto [status, span] = decoder.Next(); status != Status::Processing;
+           std::tie(status, span) = decoder.Next()) {
+        ASSERT_EQ(status, Status::FrameAvailable);
+        ASSERT_LT(frame, vectors_.size());
+        std::vector<uint8_t> actual{span.first, span.first + span.second};
+        EXPECT_THAT(actual, ElementsAreArray(vectors_[frame++].first));
+      }
+    }
+    EXPECT_EQ(frame, vectors_.size());
+  }
+}
+
+TEST(InPlaceDecoder, Overflow) {
+  InPlaceDecoder decoder(8);
+  auto [write_ptr, available] = decoder.WritePtr();
+  std::fill_n(write_ptr, available, 0x22);
+  decoder.Commit(available);
+  EXPECT_EQ(decoder.Next().first, Status::Overflow);
+  EXPECT_EQ(decoder.WritePtr().second, 8);
+}
+
+TEST(FramePool, AcquireRelease) {
+  FramePool pool(2, 16);
+  EXPECT_EQ(pool.Capacity(), 2);
+  EXPECT_EQ(pool.SlotSize(), 16);
+
+  FrameHandle a = pool.Acquire();
+  FrameHandle b = pool.Acquire();
+  ASSERT_TRUE(a);
+  ASSERT_TRUE(b);
+  EXPECT_NE(a.Data(), b.Data());
+  EXPECT_EQ(a.Size(), 16);
+  EXPECT_EQ(pool.InUse(), 2);
+
+  EXPECT_FALSE(pool.Acquire());
+  EXPECT_EQ(pool.Exhaustions(), 1);
+
+  FrameHandle moved = std::move(a);
+  EXPECT_FALSE(a);
+  EXPECT_EQ(pool.InUse(), 2);
+  moved.Reset();
+  EXPECT_EQ(pool.InUse(), 1);
+
+  b = pool.Acquire();
+  EXPECT_TRUE(b);
+  EXPECT_EQ(pool.InUse(), 1);
+}
+
+TEST(FramePool, Threads) {
+  constexpr size_t kSlots = 8;
+  FramePool pool(kSlots, 4);
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool, &failed, t] {
+      for (int i = 0; i < 20000; ++i) {
+        FrameHandle frame = pool.Acquire();
+        if (!frame) {
+          continue;
+        }
+        // Slots must not be shared between holders.
+        std::fill_n(frame.Data(), frame.Size(), static_cast<uint8_t>(t));
+        std::this_thread::yield();
+        if (std::count(frame.Data(), frame.Data() + frame.Size(), t) != 4) {
+          failed = true;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(failed);
+  EXPECT_EQ(pool.InUse(), 0);
+
+  std::vector<FrameHandle> frames;
+  for (size_t i = 0; i < kSlots; ++i) {
+    frames.push_back(pool.Acquire());
+    EXPECT_TRUE(frames.back());
+  }
+}
+
+TEST_F(TestVectorFixture, PooledDecoder) {
+  std::vector<uint8_t> stream;
+  for (auto& [decoded, encoded] : vectors_) {
+    stream.insert(stream.end(), encoded.begin(), encoded.end());
+  }
+
+  FramePool pool(vectors_.size(), 300);
+  PooledDecoder decoder(pool);
+  std::vector<FrameHandle> frames;
+  const uint8_t* input = stream.data();
+  size_t len = stream.size();
+  while (len > 0) {
+    size_t consumed;
+    auto [status, frame] = decoder.Decode(input, len, &consumed);
+    input += consumed;
+    len -= consumed;
+    if (status == Status::FrameAvailable) {
+      frames.push_back(std::move(frame));
+    }
+  }
+
+  ASSERT_EQ(frames.size(), vectors_.size());
+  EXPECT_EQ(pool.InUse(), vectors_.size());
+
+  // Frames remain valid while decoding continues and can be consumed on another thread.
+  std::thread worker([this, frames = std::move(frames)]() mutable {
+    for (size_t i = 0; i < frames.size(); ++i) {
+      std::vector<uint8_t> actual{frames[i].Data(), frames[i].Data() + frames[i].Size()};
+      EXPECT_THAT(actual, ElementsAreArray(vectors_[i].first));
+    }
+  });
+  worker.join();
+  EXPECT_EQ(pool.InUse(), 0);
+}
+
+TEST(PooledDecoder, Exhausted) {
+  FramePool pool(1, 16);
+  PooledDecoder decoder(pool);
+  const std::vector<uint8_t> encoded = {0x03, 0x11, 0x22, 0x00};
+
+  auto decode = [&decoder](const std::vector<uint8_t>& input) {
+    std::vector<std::pair<Status, FrameHandle>> results;
+    for (uint8_t byte : input) {
+      auto result = decoder.Decode(byte);
+      if (result.first != Status::Processing) {
+        results.push_back(std::move(result));
+      }
+    }
+    return results;
+  };
+
+  auto first = decode(encoded);
+  ASSERT_EQ(first.size(), 1);
+  EXPECT_EQ(first[0].first, Status::FrameAvailable);
+  EXPECT_EQ(first[0].second.Size(), 2);
+
+  // Only slot is held, so the next frame is dropped.
+  auto second = decode(encoded);
+  ASSERT_EQ(second.size(), 1);
+  EXPECT_EQ(second[0].first, Status::Overflow);
+  EXPECT_FALSE(second[0].second);
+  EXPECT_EQ(pool.Exhaustions(), 1);
+
+  first.clear();
+  auto third = decode(encoded);
+  ASSERT_EQ(third.size(), 1);
+  EXPECT_EQ(third[0].first, Status::FrameAvailable);
+  EXPECT_THAT(std::vector<uint8_t>(third[0].second.Data(), third[0].second.Data() + 2),
+              ElementsAre(0x11, 0x22));
+}
+
+TEST_F(TestVectorFixture, DecoderFromSpscRing) {
+  std::vector<uint8_t> stream;
+  for (int repeat = 0; repeat < 100; ++repeat) {
+    for (auto& [decoded, encoded] : vectors_) {
+      stream.insert(stream.end(), encoded.begin(), encoded.end());
+    }
+  }
+
+  util::SpscRing ring(512);
+  std::thread reader([&ring, &stream] {
+    for (size_t i = 0; i < stream.size();) {
+      i += ring.Write(stream.data() + i, std::min<size_t>(100, stream.size() - i));
+    }
+  });
+
+  // Decode straight out of the ring's contiguous spans.
+  Decoder decoder(1024);
+  size_t frame = 0;
+  while (frame < 100 * vectors_.size()) {
+    auto [input, len] = ring.ReadSpan();
+    while (len > 0) {
+      size_t consumed;
+      auto [status, span] = decoder.Decode(input, len, &consumed);
+      ring.Consume(consumed);
+      input += consumed;
+      len -= consumed;
+      if (status == Status::FrameAvailable) {
+        std::vector<uint8_t> actual{span.first, span.first + span.second};
+        EXPECT_THAT(actual, ElementsAreArray(vectors_[frame++ % vectors_.size()].first));
+      }
+    }
+  }
+  reader.join();
+}
@@ -0,0 +1,207 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "cobs/cc_cobs.h"
+#include "cobs/cc_frame_batch.h"
+
+using namespace testing;
+using namespace cobs;
+
+class FrameBatchFixture : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(pipe(fds_), 0);
+    for (size_t i = 0; i < 20; ++i) {
+      std::vector<uint8_t> frame(i * 37 % 300, static_cast<uint8_t>(i + 1));
+      if (!frame.empty()) {
+        frame[i % frame.size()] = 0x00;
+      }
+      frames_.push_back(frame);
+      const std::vector<uint8_t> encoded = Encode(frame.data(), frame.size());
+      expected_.insert(expected_.end(), encoded.begin(), encoded.end());
+    }
+  }
+
+  void TearDown() override {
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  std::vector<uint8_t> ReadPipe(size_t len) {
+    std::vector<uint8_t> output(len);
+    size_t pos = 0;
+    while (pos < len) {
+      const ssize_t n = read(fds_[0], output.data() + pos, len - pos);
+      if (n <= 0) {
+        break;
+      }
+      pos += static_cast<size_t>(n);
+    }
+    output.resize(pos);
+    return output;
+  }
+
+  int fds_[2];
+  std::vector<std::vector<uint8_t>> frames_;
+  std::vector<uint8_t> expected_;
+};
+
+TEST_F(FrameBatchFixture, Flush) {
+  FrameBatch batch(4096);
+  for (const auto& frame : frames_) {
+    ASSERT_TRUE(batch.Append(frame.data(), frame.size()));
+  }
+  EXPECT_EQ(batch.Frames(), frames_.size());
+  EXPECT_EQ(batch.Size(), expected_.size());
+  auto [data, len] = batch.Get();
+  EXPECT_EQ(std::vector<uint8_t>(data, data + len), expected_);
+
+  ASSERT_TRUE(batch.Flush(fds_[1]));
+  EXPECT_EQ(batch.Size(), 0);
+  EXPECT_EQ(batch.Frames(), 0);
+  EXPECT_EQ(batch.Remaining(), batch.Capacity());
+  EXPECT_EQ(ReadPipe(expected_.size()), expected_);
+}
+
+TEST_F(FrameBatchFixture, AppendSegmentsAndEncoded) {
+  std::vector<uint8_t> buf(4096);
+  FrameBatch batch(buf.data(), buf.size());
+  Encoder encoder(1024);
+  for (size_t i = 0; i < frames_.size(); ++i) {
+    const auto& frame = frames_[i];
+    const size_t half = frame.size() / 2;
+    if (i % 2) {
+      ASSERT_TRUE(batch.Append({{frame.data(), half}, {frame.data() + half, frame.size() - half}}));
+    } else {
+      encoder.Encode(frame.data(), frame.size());
+      auto [encoded, encoded_len] = encoder.Get();
+      ASSERT_TRUE(batch.AppendEncoded(encoded, encoded_len));
+    }
+  }
+  auto [data, len] = batch.Get();
+  EXPECT_EQ(data, buf.data());
+  EXPECT_EQ(std::vector<uint8_t>(data, data + len), expected_);
+}
+
+TEST(FrameBatch, Overflow) {
+  // Encodes to 302 bytes, less than MaxEncodeLen(300), so it fits exactly.
+  std::vector<uint8_t> frame(300, 0x11);
+  frame[100] = 0x00;
+  const std::vector<uint8_t> encoded = Encode(frame.data(), frame.size());
+  ASSERT_EQ(encoded.size(), 302);
+  ASSERT_GT(MaxEncodeLen(frame.size()), encoded.size());
+
+  FrameBatch batch(encoded.size() + 1);
+  EXPECT_TRUE(batch.Append(frame.data(), frame.size()));
+  EXPECT_FALSE(batch.Append(frame.data(), 0));
+  EXPECT_FALSE(batch.Append({{frame.data(), 0}}));
+  EXPECT_FALSE(batch.AppendEncoded(encoded.data(), 2));
+  EXPECT_EQ(batch.Frames(), 1);
+  EXPECT_EQ(batch.Size(), encoded.size());
+
+  batch.Clear();
+  EXPECT_TRUE(batch.Append({{frame.data(), 150}, {frame.data() + 150, 150}}));
+  EXPECT_EQ(batch.Size(), encoded.size());
+  batch.Clear();
+  EXPECT_TRUE(batch.AppendEncoded(encoded.data(), encoded.size()));
+  EXPECT_FALSE(batch.AppendEncoded(encoded.data(), 2));
+}
+
+TEST_F(FrameBatchFixture, NonBlockingPartialFlush) {
+  ASSERT_EQ(fcntl(fds_[1], F_SETFL, O_NONBLOCK), 0);
+  const size_t pipe_size = static_cast<size_t>(fcntl(fds_[1], F_GETPIPE_SZ));
+
+  FrameBatch batch(pipe_size * 2 + 1024);
+  std::vector<uint8_t> expected;
+  const std::vector<uint8_t> frame(200, 0x42);
+  const std::vector<uint8_t> encoded = Encode(frame.data(), frame.size());
+  while (batch.Append(frame.data(), frame.size())) {
+    expected.insert(expected.end(), encoded.begin(), encoded.end());
+  }
+
+  EXPECT_FALSE(batch.Flush(fds_[1]));
+  EXPECT_EQ(errno, EAGAIN);
+  EXPECT_EQ(batch.Size(), expected.size() - pipe_size);
+  std::vector<uint8_t> output = ReadPipe(pipe_size);
+  while (!batch.Flush(fds_[1])) {
+    ASSERT_EQ(errno, EAGAIN);
+    const std::vector<uint8_t> more = ReadPipe(pipe_size);
+    output.insert(output.end(), more.begin(), more.end());
+  }
+  const std::vector<uint8_t> rest = ReadPipe(expected.size() - output.size());
+  output.insert(output.end(), rest.begin(), rest.end());
+  EXPECT_EQ(output, expected);
+}
+
+TEST(FrameBatch, FlushPolicy) {
+  const uint8_t frame[] = {0x11, 0x22, 0x33};
+
+  FlushPolicy policy;
+  policy.max_bytes = 10;
+  FrameBatch by_bytes(1024, policy);
+  EXPECT_FALSE(by_bytes.ShouldFlush());
+  by_bytes.Append(frame, sizeof(frame));
+  EXPECT_FALSE(by_bytes.ShouldFlush());
+  by_bytes.Append(frame, sizeof(frame));
+  EXPECT_TRUE(by_bytes.ShouldFlush());
+
+  policy = {};
+  policy.max_frames = 3;
+  FrameBatch by_frames(1024, policy);
+  by_frames.Append(frame, sizeof(frame));
+  by_frames.Append(frame, sizeof(frame));
+  EXPECT_FALSE(by_frames.ShouldFlush());
+  by_frames.Append(frame, sizeof(frame));
+  EXPECT_TRUE(by_frames.ShouldFlush());
+
+  policy = {};
+  policy.max_delay = std::chrono::hours(1);
+  FrameBatch by_time(1024, policy);
+  EXPECT_EQ(by_time.Deadline(), FrameBatch::Clock::time_point::max());
+  const auto before = FrameBatch::Clock::now();
+  by_time.Append(frame, sizeof(frame));
+  EXPECT_FALSE(by_time.ShouldFlush());
+  EXPECT_TRUE(by_time.ShouldFlush(before + std::chrono::hours(2)));
+  EXPECT_GE(by_time.Deadline(), before + std::chrono::hours(1));
+  EXPECT_LE(by_time.Deadline(), FrameBatch::Clock::now() + std::chrono::hours(1));
+  by_time.Clear();
+  EXPECT_FALSE(by_time.ShouldFlush(before + std::chrono::hours(2)));
+
+  FrameBatch never(1024);
+  never.Append(frame, sizeof(frame));
+  EXPECT_FALSE(never.ShouldFlush(FrameBatch::Clock::time_point::max()));
+  EXPECT_EQ(never.Deadline(), FrameBatch::Clock::time_point::max());
+}
+
+#ifdef COBS_IO_URING
+TEST_F(FrameBatchFixture, FlushUring) {
+  UringWriter uring;
+  if (!uring.Ok()) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+  FrameBatch batch(4096);
+  for (int round = 0; round < 3; ++round) {
+    for (const auto& frame : frames_) {
+      ASSERT_TRUE(batch.Append(frame.data(), frame.size()));
+    }
+    ASSERT_TRUE(batch.Flush(uring, fds_[1]));
+    EXPECT_EQ(batch.Size(), 0);
+    EXPECT_EQ(ReadPipe(expected_.size()), expected_);
+  }
+
+  EXPECT_EQ(uring.Write(-1, expected_.data(), expected_.size()), -1);
+  EXPECT_EQ(errno, EBADF);
+
+  // Each completion is reaped by its own Write(), so a failure leaves nothing behind.
+  ASSERT_EQ(uring.Write(fds_[1], expected_.data(), expected_.size()),
+            static_cast<ssize_t>(expected_.size()));
+  EXPECT_EQ(ReadPipe(expected_.size()), expected_);
+}
+#endif
@@ -0,0 +1,84 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "cobs/cc_cobs.h"
+#include "cobs/cc_parallel_decode.h"
+#include "util/thread_pool.h"
+
+using namespace testing;
+using namespace cobs;
+
+// Back to back frames of uneven sizes with corrupt bytes and a trailing partial frame.
+static std::vector<uint8_t> MakeCapture() {
+  std::mt19937 rng(1);
+  std::vector<uint8_t> capture;
+  for (int i = 0; i < 2000; ++i) {
+    std::vector<uint8_t> payload(i % 100 == 0 ? 5000 : rng() % 300);
+    for (auto& byte : payload) {
+      byte = rng() % 4 ? static_cast<uint8_t>(rng()) : 0;
+    }
+    std::vector<uint8_t> encoded = Encode(payload.data(), payload.size());
+    if (i % 37 == 0 && encoded.size() > 2) {
+      encoded[rng() % (encoded.size() - 1)] = static_cast<uint8_t>(rng() % 2 ? 0x00 : 0xFF);
+    }
+    capture.insert(capture.end(), encoded.begin(), encoded.end());
+  }
+  capture.push_back(0x03);
+  capture.push_back(0x11);
+  return capture;
+}
+
+// Reference results from decoding the whole capture sequentially.
+static std::vector<std::pair<Status, std::vector<uint8_t>>> DecodeSequential(
+    const std::vector<uint8_t>& capture) {
+  std::vector<std::pair<Status, std::vector<uint8_t>>> frames;
+  Decoder decoder(capture.size());
+  const uint8_t* input = capture.data();
+  size_t len = capture.size();
+  while (len > 0) {
+    size_t consumed;
+    auto [status, span] = decoder.Decode(input, len, &consumed);
+    input += consumed;
+    len -= consumed;
+    if (status == Status::Processing) {
+      status = Status::IncompleteFrame;
+    }
+    frames.push_back({status, {span.first, span.first + span.second}});
+  }
+  return frames;
+}
+
+TEST(ParallelDecode, MatchesSequential) {
+  const std::vector<uint8_t> capture = MakeCapture();
+  const auto expected = DecodeSequential(capture);
+  util::ThreadPool pool(4);
+
+  for (size_t shard_size : {size_t{1}, size_t{64}, size_t{4096}, kParallelDecodeShard}) {
+    SCOPED_TRACE("Shard size: " + std::to_string(shard_size));
+    std::vector<uint8_t> output(capture.size());
+    const auto frames = ParallelDecode(capture.data(), capture.size(), output.data(), pool,
+                                       shard_size);
+
+    ASSERT_EQ(frames.size(), expected.size());
+    size_t offset = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+      EXPECT_EQ(frames[i].status, expected[i].first);
+      EXPECT_EQ(frames[i].offset, offset);
+      std::vector<uint8_t> actual{frames[i].data, frames[i].data + frames[i].len};
+      EXPECT_EQ(actual, expected[i].second);
+      offset += frames[i].encoded_len;
+    }
+    EXPECT_EQ(offset, capture.size());
+    EXPECT_EQ(frames.back().status, Status::IncompleteFrame);
+  }
+}
+
+TEST(ParallelDecode, Empty) {
+  util::ThreadPool pool(2);
+  EXPECT_THAT(ParallelDecode(nullptr, 0, nullptr, pool), IsEmpty());
+}
@@ -0,0 +1,71 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "cobs/cc_cobs.h"
+#include "cobs/cc_parallel_encode.h"
+#include "util/thread_pool.h"
+
+using namespace testing;
+using namespace cobs;
+
+// Messages of uneven sizes, including empty ones and runs around the 254 byte group size.
+static std::vector<std::vector<uint8_t>> MakeMessages() {
+  std::mt19937 rng(1);
+  std::vector<std::vector<uint8_t>> messages;
+  for (size_t i = 0; i < 2000; ++i) {
+    std::vector<uint8_t> message(i % 100 == 0 ? 5000 : i % 7 == 0 ? 253 + i % 3 : rng() % 300);
+    for (auto& byte : message) {
+      byte = rng() % (i % 2 ? 4 : 400) ? static_cast<uint8_t>(rng() | 1) : 0;
+    }
+    messages.push_back(std::move(message));
+  }
+  return messages;
+}
+
+TEST(ParallelEncode, MatchesSequential) {
+  const auto messages = MakeMessages();
+  std::vector<std::pair<const uint8_t*, size_t>> spans;
+  std::vector<uint8_t> expected;
+  std::vector<size_t> expected_offsets{0};
+  for (const auto& message : messages) {
+    spans.push_back({message.data(), message.size()});
+    const std::vector<uint8_t> encoded = Encode(message.data(), message.size());
+    expected.insert(expected.end(), encoded.begin(), encoded.end());
+    expected_offsets.push_back(expected.size());
+  }
+  util::ThreadPool pool(4);
+
+  for (size_t shard_size : {size_t{1}, size_t{64}, size_t{4096}, kParallelEncodeShard}) {
+    SCOPED_TRACE("Shard size: " + std::to_string(shard_size));
+    const auto [output, offsets] = ParallelEncode(spans, pool, shard_size);
+    EXPECT_EQ(offsets, expected_offsets);
+    EXPECT_EQ(output, expected);
+  }
+}
+
+TEST(ParallelEncode, PreallocatedOutput) {
+  const std::vector<uint8_t> message = {0x11, 0x00, 0x22};
+  const std::vector<std::pair<const uint8_t*, size_t>> spans = {
+      {message.data(), message.size()}, {nullptr, 0}, {message.data(), 1}};
+  util::ThreadPool pool(2);
+
+  const std::vector<size_t> offsets = ParallelEncodeOffsets(spans, pool);
+  EXPECT_THAT(offsets, ElementsAre(0, 5, 7, 10));
+  std::vector<uint8_t> output(offsets.back());
+  ParallelEncode(spans, offsets, output.data(), pool);
+  EXPECT_THAT(output, ElementsAre(0x02, 0x11, 0x02, 0x22, 0x00, 0x01, 0x00, 0x02, 0x11, 0x00));
+}
+
+TEST(ParallelEncode, Empty) {
+  util::ThreadPool pool(2);
+  const auto [output, offsets] = ParallelEncode({}, pool);
+  EXPECT_THAT(output, IsEmpty());
+  EXPECT_THAT(offsets, ElementsAre(0));
+}
@@ -1,3 +1,5 @@
+import array
+import threading
 import unittest
 
 from cobs import py_cobs
@@ -14,6 +16,14 @@ class TestLengths(unittest.TestCase):
     self.assertEqual(511, py_cobs.max_encode_len(508))
     self.assertEqual(513, py_cobs.max_encode_len(509))
 
+  def test_encode_headroom(self):
+    self.assertEqual(2, py_cobs.encode_headroom(0))
+    self.assertEqual(2, py_cobs.encode_headroom(1))
+    self.assertEqual(2, py_cobs.encode_headroom(254))
+    self.assertEqual(3, py_cobs.encode_headroom(255))
+    self.assertEqual(3, py_cobs.encode_headroom(508))
+    self.assertEqual(4, py_cobs.encode_headroom(509))
+
   def test_decoded_len(self):
     self.assertEqual(0, py_cobs.max_decode_len(-1))
     self.assertEqual(0, py_cobs.max_decode_len(0))
@@ -22,6 +32,16 @@ class TestLengths(unittest.TestCase):
     self.assertEqual(1, py_cobs.max_decode_len(3))
     self.assertEqual(1000, py_cobs.max_decode_len(1002))
 
+  def test_mode_lens(self):
+    self.assertEqual(py_cobs.max_encode_len(1000),
+                     py_cobs.max_encode_len(1000, py_cobs.Mode.Reduced))
+    self.assertEqual(2, py_cobs.max_encode_len(0, py_cobs.Mode.Zpe))
+    self.assertEqual(225, py_cobs.max_encode_len(223, py_cobs.Mode.Zpe))
+    self.assertEqual(227, py_cobs.max_encode_len(224, py_cobs.Mode.Zpe))
+    self.assertEqual(1001, py_cobs.max_decode_len(1002, py_cobs.Mode.Reduced))
+    self.assertEqual(0, py_cobs.max_decode_len(1, py_cobs.Mode.Zpe))
+    self.assertEqual(5, py_cobs.max_decode_len(4, py_cobs.Mode.Zpe))
+
 
 class TestEncodeDecode(unittest.TestCase):
 
@@ -93,6 +113,16 @@ class TestEncodeDecode(unittest.TestCase):
           j += BLOCK_SIZE
         self.assertSequenceEqual(bytes(encoded), encoder.get())
 
+  def test_encode_in_place(self):
+    for i, (decoded, encoded) in enumerate(self.vectors):
+      with self.subTest(vector=i):
+        headroom = py_cobs.encode_headroom(len(decoded))
+        buf = bytearray(headroom) + bytearray(decoded)
+        self.assertEqual(bytes(encoded), py_cobs.encode_in_place(buf, headroom))
+
+    with self.assertRaises(ValueError):
+      py_cobs.encode_in_place(bytearray(300), 2)
+
   def test_decode(self):
     for i, (decoded, encoded) in enumerate(self.vectors):
       with self.subTest(vector=i):
@@ -101,6 +131,20 @@ class TestEncodeDecode(unittest.TestCase):
         self.assertIsNotNone(actual)
         self.assertSequenceEqual(bytes(decoded), actual)  # type:ignore
 
+  def test_decode_in_place(self):
+    for i, (decoded, encoded) in enumerate(self.vectors):
+      with self.subTest(vector=i):
+        buf = bytearray(encoded)
+        status, view = py_cobs.decode_in_place(buf)
+        self.assertEqual(py_cobs.Status.FrameAvailable, status)
+        self.assertIsNotNone(view)
+        self.assertEqual(bytes(decoded), view)
+        self.assertEqual(bytes(decoded), buf[:len(decoded)])
+
+    status, view = py_cobs.decode_in_place(bytearray([0x03, 0x11]))
+    self.assertEqual(py_cobs.Status.IncompleteFrame, status)
+    self.assertIsNone(view)
+
   def test_decode_incomplete_frame(self):
     encoded = bytes([0x01, 0x01])
     status, actual = py_cobs.decode(encoded)
@@ -148,6 +192,168 @@ class TestEncodeDecode(unittest.TestCase):
         self.assertIsNotNone(buf)
         self.assertSequenceEqual(bytes(decoded), buf)  # type: ignore
 
+  def test_decoder_block(self):
+    decoder = py_cobs.Decoder(1024)
+    stream = b''.join(bytes(encoded) for _, encoded in self.vectors)
+    stream += bytes([0xAA, 0xFF, 0xFF, 0xFF, 0x00])
+
+    frames = []
+    while stream:
+      status, buf, consumed = decoder.decode_block(stream)
+      self.assertGreater(consumed, 0)
+      stream = stream[consumed:]
+      frames.append((status, buf))
+
+    expected = [(py_cobs.Status.FrameAvailable, bytes(decoded)) for decoded, _ in self.vectors]
+    expected.append((py_cobs.Status.MalformedFrame, None))
+    self.assertEqual(expected, frames)
+
+    status, buf, consumed = decoder.decode_block(bytes([0x03, 0x11]))
+    self.assertEqual((py_cobs.Status.Processing, None, 2), (status, buf, consumed))
+
+  def test_decoder_feed(self):
+    stream = b''.join(bytes(encoded) for _, encoded in self.vectors)
+    stream += bytes([0xAA, 0xFF, 0xFF, 0xFF, 0x00, 0x03, 0x11, 0x00, 0x02, 0x22, 0x00])
+
+    # Byte at a time decoding is the reference.
+    decoder = py_cobs.Decoder(64)
+    expected = []
+    for b in stream:
+      status, buf = decoder.decode(b)
+      if status != py_cobs.Status.Processing:
+        expected.append(py_cobs.Frame(status, buf))
+    self.assertIn(py_cobs.Status.Overflow, [frame.status for frame in expected])
+    self.assertIn(py_cobs.Status.MalformedFrame, [frame.status for frame in expected])
+
+    for chunk_size in (1, 3, 7, 100, len(stream)):
+      for feed in ('feed', 'feed_iter'):
+        with self.subTest(chunk_size=chunk_size, feed=feed):
+          decoder = py_cobs.Decoder(64)
+          frames = []
+          for i in range(0, len(stream), chunk_size):
+            frames.extend(getattr(decoder, feed)(bytearray(stream[i:i + chunk_size])))
+          self.assertEqual(expected, frames)
+
+  def test_decoder_feed_partial(self):
+    decoder = py_cobs.Decoder(64)
+    self.assertEqual([], decoder.feed(b''))
+    self.assertEqual([], decoder.feed(bytes([0x03, 0x11])))
+    frames = decoder.feed(memoryview(bytes([0x22, 0x00, 0x02, 0x33])))
+    self.assertEqual([(py_cobs.Status.FrameAvailable, bytes([0x11, 0x22]))], frames)
+    self.assertEqual(py_cobs.Status.FrameAvailable, frames[0].status)
+
+    frames = decoder.feed_iter(bytes([0x00, 0x01, 0x00]))
+    self.assertEqual(py_cobs.Frame(py_cobs.Status.FrameAvailable, bytes([0x33])), next(frames))
+    self.assertEqual(py_cobs.Frame(py_cobs.Status.FrameAvailable, b''), next(frames))
+    self.assertIsNone(next(frames, None))
+
+
+class TestModes(unittest.TestCase):
+
+  def setUp(self):
+    self.vectors = [
+        (py_cobs.Mode.Reduced, [], [0x01, 0x00]),
+        (py_cobs.Mode.Reduced, [0x11, 0x22, 0x33], [0x33, 0x11, 0x22, 0x00]),
+        (py_cobs.Mode.Reduced, [0x11, 0x22, 0x02], [0x04, 0x11, 0x22, 0x02, 0x00]),
+        (py_cobs.Mode.Zpe, [], [0x01, 0x00]),
+        (py_cobs.Mode.Zpe, [0x00], [0xE1, 0x00]),
+        (py_cobs.Mode.Zpe, [0x11, 0x00, 0x00, 0x22], [0xE2, 0x11, 0x02, 0x22, 0x00]),
+        (py_cobs.Mode.Zpe, [0x11, 0x00, 0x22], [0x02, 0x11, 0x02, 0x22, 0x00]),
+    ]
+
+  def test_encode_decode(self):
+    for i, (mode, decoded, encoded) in enumerate(self.vectors):
+      with self.subTest(vector=i):
+        self.assertEqual(bytes(encoded), py_cobs.encode(bytes(decoded), mode))
+        self.assertEqual((py_cobs.Status.FrameAvailable, bytes(decoded)),
+                         py_cobs.decode(bytes(encoded), mode))
+
+  def test_encoder_decoder(self):
+    for mode in py_cobs.Mode:
+      with self.subTest(mode=mode):
+        encoder = py_cobs.Encoder(1024, mode)
+        decoder = py_cobs.Decoder(1024, mode)
+        payload = bytes([0x01, 0x00, 0x00, 0x00, 0x2A, 0x00, 0x00, 0x00] * 20)
+        for _ in range(2):
+          encoder.encode(payload[:50])
+          encoder.encode(payload[50:])
+          encoded = encoder.get()
+          self.assertEqual(py_cobs.encode(payload, mode), encoded)
+          self.assertEqual((py_cobs.Status.FrameAvailable, payload, len(encoded)),
+                           decoder.decode_block(encoded))
+
+  def test_zpe_overhead(self):
+    payload = bytes([0x01, 0x00, 0x00, 0x00, 0x2A, 0x00, 0x00, 0x00] * 20)
+    self.assertLess(len(py_cobs.encode(payload, py_cobs.Mode.Zpe)), len(py_cobs.encode(payload)))
+
+
+class TestBuffers(unittest.TestCase):
+
+  def setUp(self):
+    self.decoded = bytes([0x11, 0x22, 0x00, 0x33])
+    self.encoded = bytes([0x03, 0x11, 0x22, 0x02, 0x33, 0x00])
+
+  def test_buffer_types(self):
+    for buf_type in (bytes, bytearray, memoryview, lambda b: array.array('B', b)):
+      with self.subTest(buf_type=buf_type):
+        self.assertEqual(self.encoded, py_cobs.encode(buf_type(self.decoded)))
+        self.assertEqual((py_cobs.Status.FrameAvailable, self.decoded),
+                         py_cobs.decode(buf_type(self.encoded)))
+
+        encoder = py_cobs.Encoder(16)
+        encoder.encode(buf_type(self.decoded))
+        self.assertEqual(self.encoded, encoder.get())
+
+        decoder = py_cobs.Decoder(16)
+        self.assertEqual((py_cobs.Status.FrameAvailable, self.decoded, len(self.encoded)),
+                         decoder.decode_block(buf_type(self.encoded)))
+
+  def test_multibyte_items(self):
+    # Items wider than a byte are encoded as their raw bytes.
+    words = array.array('H', [0x1122, 0x0033])
+    self.assertEqual(py_cobs.encode(words.tobytes()), py_cobs.encode(words))
+
+  def test_memoryview_slice(self):
+    buf = bytearray(b'\xff' + self.encoded + b'\xff')
+    self.assertEqual((py_cobs.Status.FrameAvailable, self.decoded),
+                     py_cobs.decode(memoryview(buf)[1:-1]))
+
+  def test_in_place_memoryview(self):
+    buf = bytearray(self.encoded)
+    status, view = py_cobs.decode_in_place(memoryview(buf))
+    self.assertEqual(py_cobs.Status.FrameAvailable, status)
+    self.assertEqual(self.decoded, view)
+
+    with self.assertRaises(TypeError):
+      py_cobs.decode_in_place(self.encoded)
+
+  def test_invalid_mode(self):
+    with self.assertRaises(ValueError):
+      py_cobs.encode(self.decoded, 3)
+    with self.assertRaises(ValueError):
+      py_cobs.Decoder(16, -1)
+
+  def test_large_threaded(self):
+    # Large inputs are processed with the GIL released.
+    payload = bytes((i * 7 + 3) % 256 for i in range(1 << 20))
+    expected = py_cobs.encode(payload)
+    results = []
+
+    def work():
+      encoded = py_cobs.encode(payload)
+      results.append((encoded, py_cobs.decode(encoded)))
+
+    threads = [threading.Thread(target=work) for _ in range(4)]
+    for thread in threads:
+      thread.start()
+    for thread in threads:
+      thread.join()
+
+    self.assertEqual(4, len(results))
+    for encoded, decoded in results:
+      self.assertEqual(expected, encoded)
+      self.assertEqual((py_cobs.Status.FrameAvailable, payload), decoded)
+
 
 if __name__ == '__main__':
   unittest.main()
@@ -0,0 +1,198 @@
+import asyncio
+import os
+import socket
+import tty
+import unittest
+
+from cobs import py_cobs
+from cobs import py_cobs_asyncio
+
+
+def make_payloads(n):
+  return [bytes((i * 7 + j) % 256 for j in range(i % 300)) for i in range(n)]
+
+
+class FakeTransport(asyncio.Transport):
+
+  def __init__(self):
+    super().__init__()
+    self.writes = []
+    self.paused = False
+    self.pauses = 0
+
+  def write(self, data):
+    self.writes.append(bytes(data))
+
+  def pause_reading(self):
+    self.paused = True
+    self.pauses += 1
+
+  def resume_reading(self):
+    self.paused = False
+
+
+class TestFrameWriter(unittest.IsolatedAsyncioTestCase):
+
+  async def test_coalesce(self):
+    transport = FakeTransport()
+    writer = py_cobs_asyncio.FrameWriter(transport)
+    payloads = make_payloads(100)
+    for payload in payloads[:50]:
+      writer.write(payload)
+    writer.write_many(payloads[50:99])
+    encoder = py_cobs.Encoder(1024)
+    encoder.encode(payloads[99])
+    writer.write_encoded(encoder.get())
+    self.assertEqual([], transport.writes)
+
+    await asyncio.sleep(0)
+    self.assertEqual([b''.join(py_cobs.encode(payload) for payload in payloads)], transport.writes)
+    self.assertEqual(0, writer.buffered())
+
+  async def test_max_buffered(self):
+    transport = FakeTransport()
+    writer = py_cobs_asyncio.FrameWriter(transport, py_cobs.Mode.Reduced, max_buffered=100)
+    writer.write(bytes(60))
+    writer.write(bytes(60))
+    self.assertEqual(1, len(transport.writes))
+    writer.write(b'\x01')
+    await writer.drain()
+    self.assertEqual(py_cobs.encode(b'\x01', py_cobs.Mode.Reduced), transport.writes[-1])
+
+
+class TestFrameProtocol(unittest.IsolatedAsyncioTestCase):
+
+  async def test_backpressure(self):
+    transport = FakeTransport()
+    protocol = py_cobs_asyncio.FrameProtocol(1024, max_queued=8)
+    protocol.connection_made(transport)
+    payloads = make_payloads(20)
+    protocol.data_received(b''.join(py_cobs.encode(payload) for payload in payloads))
+    self.assertTrue(transport.paused)
+
+    frames = []
+    for _ in range(15):
+      frames.append(await anext(protocol))
+    self.assertTrue(transport.paused)
+    frames.append(await anext(protocol))
+    self.assertFalse(transport.paused)
+
+    protocol.eof_received()
+    frames += [frame async for frame in protocol]
+    self.assertEqual([(py_cobs.Status.FrameAvailable, payload) for payload in payloads], frames)
+    self.assertEqual(1, transport.pauses)
+
+  async def test_errors_and_split_frames(self):
+    protocol = py_cobs_asyncio.FrameProtocol(4)
+    protocol.connection_made(FakeTransport())
+    protocol.data_received(bytes([0x03, 0x11]))
+    protocol.data_received(bytes([0x22, 0x00, 0x06, 1, 2, 3, 4, 5, 0x00, 0x02, 0x11, 0x00]))
+    protocol.connection_lost(None)
+    statuses = [frame.status async for frame in protocol]
+    self.assertEqual(py_cobs.Status.FrameAvailable, statuses[0])
+    self.assertIn(py_cobs.Status.Overflow, statuses)
+
+  async def test_connection_lost(self):
+    protocol = py_cobs_asyncio.FrameProtocol(4)
+    protocol.connection_made(FakeTransport())
+    protocol.connection_lost(ConnectionResetError())
+    with self.assertRaises(ConnectionResetError):
+      await anext(protocol)
+
+  async def test_concurrent_drain(self):
+    transport = FakeTransport()
+    protocol = py_cobs_asyncio.FrameProtocol(1024)
+    protocol.connection_made(transport)
+    protocol.pause_writing()
+
+    async def produce(payload):
+      protocol.write(payload)
+      await protocol.drain()
+
+    tasks = [asyncio.create_task(produce(bytes([i]))) for i in range(1, 4)]
+    await asyncio.sleep(0)
+    self.assertFalse(any(task.done() for task in tasks))
+    protocol.resume_writing()
+    await asyncio.wait_for(asyncio.gather(*tasks), 1)
+
+    protocol.pause_writing()
+    tasks = [asyncio.create_task(protocol.drain()) for _ in range(2)]
+    await asyncio.sleep(0)
+    protocol.connection_lost(None)
+    for task in tasks:
+      with self.assertRaises(ConnectionResetError):
+        await asyncio.wait_for(task, 1)
+
+  async def test_socketpair(self):
+    loop = asyncio.get_running_loop()
+    sock_a, sock_b = socket.socketpair()
+    _, receiver = await loop.create_connection(
+        lambda: py_cobs_asyncio.FrameProtocol(1024, max_queued=16), sock=sock_a)
+    transport, sender = await loop.create_connection(lambda: py_cobs_asyncio.FrameProtocol(1024),
+                                                     sock=sock_b)
+    payloads = make_payloads(2000)
+
+    async def send():
+      for i, payload in enumerate(payloads):
+        sender.write(payload)
+        if i % 100 == 0:
+          await sender.drain()
+      await sender.drain()
+      transport.close()
+
+    send_task = asyncio.create_task(send())
+    frames = [frame async for frame in receiver]
+    await send_task
+    self.assertEqual([(py_cobs.Status.FrameAvailable, payload) for payload in payloads], frames)
+
+  async def test_pty(self):
+    loop = asyncio.get_running_loop()
+    master, slave = os.openpty()
+    tty.setraw(master)
+    tty.setraw(slave)
+    read_pipe = os.fdopen(master, 'rb', buffering=0)
+    write_pipe = os.fdopen(slave, 'wb', buffering=0)
+    read_transport, receiver = await loop.connect_read_pipe(
+        lambda: py_cobs_asyncio.FrameProtocol(1024, py_cobs.Mode.Zpe), read_pipe)
+    write_transport, _ = await loop.connect_write_pipe(asyncio.Protocol, write_pipe)
+    writer = py_cobs_asyncio.FrameWriter(write_transport, py_cobs.Mode.Zpe)
+
+    payloads = make_payloads(200) + [bytes(100)]
+    writer.write_many(payloads)
+    await writer.drain()
+
+    frames = []
+    async for frame in receiver:
+      frames.append(frame)
+      if len(frames) == len(payloads):
+        break
+    write_transport.close()
+    read_transport.close()
+    self.assertEqual([(py_cobs.Status.FrameAvailable, payload) for payload in payloads], frames)
+
+
+class TestReadFrames(unittest.IsolatedAsyncioTestCase):
+
+  async def test_stream_reader(self):
+    sock_a, sock_b = socket.socketpair()
+    reader, reader_writer = await asyncio.open_connection(sock=sock_a)
+    _, stream_writer = await asyncio.open_connection(sock=sock_b)
+    writer = py_cobs_asyncio.FrameWriter(stream_writer)
+    payloads = make_payloads(500)
+
+    async def send():
+      for payload in payloads:
+        writer.write(payload)
+      await writer.drain()
+      stream_writer.close()
+      await stream_writer.wait_closed()
+
+    send_task = asyncio.create_task(send())
+    frames = [frame async for frame in py_cobs_asyncio.read_frames(reader, 1024, read_size=999)]
+    await send_task
+    reader_writer.close()
+    self.assertEqual([(py_cobs.Status.FrameAvailable, payload) for payload in payloads], frames)
+
+
+if __name__ == '__main__':
+  unittest.main()
@@ -3,6 +3,280 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRC_X86_CLMUL
+#include <immintrin.h>
+#endif
+
+// Minimum length at which Crc*Seq uses the selected kernel instead of the byte table.
+static const size_t kCrcKernelMinLen = 64;
+
+// Minimum length for carry-less multiply folding.
+static const size_t kCrcClmulMinLen = 64;
+
+static inline uint16_t CrcByteSwap16(uint16_t x) { return (uint16_t)((x << 8) | (x >> 8)); }
+
+static inline uint32_t CrcByteSwap32(uint32_t x) {
+  return (x << 24) | ((x << 8) & 0x00FF0000) | ((x >> 8) & 0x0000FF00) | (x >> 24);
+}
+
+// Independent CRC streams interleaved by Crc*BlockBatch to overlap their table lookup latency.
+#define CRC_BATCH_LANES 4
+
+typedef struct {
+  const uint8_t *input;
+  size_t len;
+  size_t index;
+  uint32_t crc;
+} CrcBatchLane;
+
+#ifdef CRC_X86_CLMUL
+#define CRC_CLMUL_TARGET __attribute__((target("pclmul,ssse3,sse4.1")))
+
+// Also called from the load time constructor, which may run before libgcc has detected the CPU.
+static bool CrcHaveClmul(void) {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+// Load 16 bytes so that lane bit order matches the CRC bit order.
+CRC_CLMUL_TARGET static inline __m128i CrcClmulLoad(const uint8_t *input, bool lsb_first) {
+  const __m128i data = _mm_loadu_si128((const __m128i *)input);
+  if (lsb_first) {
+    return data;
+  }
+  const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  return _mm_shuffle_epi8(data, reverse);
+}
+
+CRC_CLMUL_TARGET static inline __m128i CrcClmulFold(__m128i x, __m128i k, __m128i data) {
+  const __m128i low = _mm_clmulepi64_si128(x, k, 0x00);
+  const __m128i high = _mm_clmulepi64_si128(x, k, 0x11);
+  return _mm_xor_si128(_mm_xor_si128(low, high), data);
+}
+
+// Fold len / 16 blocks of 16 bytes with carry-less multiplies, then Barrett reduce to the CRC.
+// "bits" wide CRCs are processed scaled up to 32 bits.  Requires len >= 64.
+CRC_CLMUL_TARGET static uint32_t CrcClmul(const CrcClmulInfo *clmul, unsigned bits,
+                                          bool lsb_first, const uint8_t *input, size_t len,
+                                          uint32_t crc) {
+  __m128i x0 = CrcClmulLoad(input, lsb_first);
+  __m128i x1 = CrcClmulLoad(input + 16, lsb_first);
+  __m128i x2 = CrcClmulLoad(input + 32, lsb_first);
+  __m128i x3 = CrcClmulLoad(input + 48, lsb_first);
+  input += 64;
+  len -= 64;
+
+  // Initial CRC is XORed into the leading 32 bits of the message.
+  if (lsb_first) {
+    x0 = _mm_xor_si128(x0, _mm_cvtsi32_si128((int)crc));
+  } else {
+    x0 = _mm_xor_si128(x0, _mm_slli_si128(_mm_cvtsi32_si128((int)(crc << (32 - bits))), 12));
+  }
+
+  // Four independent folding streams.
+  const __m128i fold_512 = _mm_loadu_si128((const __m128i *)clmul->fold_512);
+  while (len >= 64) {
+    x0 = CrcClmulFold(x0, fold_512, CrcClmulLoad(input, lsb_first));
+    x1 = CrcClmulFold(x1, fold_512, CrcClmulLoad(input + 16, lsb_first));
+    x2 = CrcClmulFold(x2, fold_512, CrcClmulLoad(input + 32, lsb_first));
+    x3 = CrcClmulFold(x3, fold_512, CrcClmulLoad(input + 48, lsb_first));
+    input += 64;
+    len -= 64;
+  }
+
+  const __m128i fold_128 = _mm_loadu_si128((const __m128i *)clmul->fold_128);
+  __m128i x = CrcClmulFold(x0, fold_128, x1);
+  x = CrcClmulFold(x, fold_128, x2);
+  x = CrcClmulFold(x, fold_128, x3);
+  while (len >= 16) {
+    x = CrcClmulFold(x, fold_128, CrcClmulLoad(input, lsb_first));
+    input += 16;
+    len -= 16;
+  }
+
+  const __m128i reduce = _mm_loadu_si128((const __m128i *)clmul->reduce);
+  const __m128i barrett = _mm_loadu_si128((const __m128i *)clmul->barrett);
+
+  if (lsb_first) {
+    // Reflected operands: the remainder ends up in the high lane.
+    const __m128i w = _mm_xor_si128(_mm_clmulepi64_si128(x, reduce, 0x00),
+                                    _mm_slli_si128(_mm_srli_si128(x, 8), 4));
+    const uint64_t t = (uint64_t)_mm_extract_epi64(_mm_clmulepi64_si128(w, reduce, 0x10), 1) ^
+                       (uint64_t)_mm_extract_epi64(w, 1);
+
+    const __m128i t1 = _mm_cvtsi64_si128((long long)(t & 0xFFFFFFFF));
+    const uint64_t q = (uint64_t)_mm_cvtsi128_si64(_mm_clmulepi64_si128(t1, barrett, 0x00)) &
+                       0x7FFFFFFF80000000;
+    const __m128i qp = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)q), barrett, 0x10);
+    return (uint32_t)((((uint64_t)_mm_extract_epi64(qp, 1) >> 30) ^ (t >> 32)) & 0xFFFFFFFF);
+  }
+
+  const __m128i w = _mm_xor_si128(_mm_clmulepi64_si128(x, reduce, 0x11),
+                                  _mm_slli_si128(_mm_move_epi64(x), 4));
+  const uint64_t t = (uint64_t)_mm_cvtsi128_si64(_mm_clmulepi64_si128(w, reduce, 0x01)) ^
+                     (uint64_t)_mm_cvtsi128_si64(w);
+
+  const __m128i t1 = _mm_cvtsi64_si128((long long)(t >> 32));
+  const uint64_t q = (uint64_t)_mm_cvtsi128_si64(_mm_clmulepi64_si128(t1, barrett, 0x00)) >> 32;
+  const __m128i qp = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)q), barrett, 0x10);
+  const uint64_t r = (t ^ (uint64_t)_mm_cvtsi128_si64(qp)) & 0xFFFFFFFF;
+  return (uint32_t)(r >> (32 - bits));
+}
+#endif
+
+typedef struct {
+  const char *name;
+  bool (*supported)(void);
+  uint16_t (*seq16)(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc);
+  uint32_t (*seq32)(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc);
+} CrcKernelImpl;
+
+static bool CrcAlwaysSupported(void) { return true; }
+
+static bool CrcClmulSupported(void) {
+#ifdef CRC_X86_CLMUL
+  return CrcHaveClmul();
+#else
+  return false;
+#endif
+}
+
+// Ordered slowest to fastest.
+static const CrcKernelImpl kCrcKernels[kNumCrcKernel] = {
+    [kCrcKernelTable] = {"table", CrcAlwaysSupported, Crc16SeqTable, Crc32SeqTable},
+    [kCrcKernelSliced] = {"sliced", CrcAlwaysSupported, Crc16SeqSliced, Crc32SeqSliced},
+    [kCrcKernelClmul] = {"pclmul", CrcClmulSupported, Crc16SeqClmul, Crc32SeqClmul},
+};
+
+// Replaced with the fastest supported kernel at load time.
+static const CrcKernelImpl *g_crc_kernel = &kCrcKernels[kCrcKernelSliced];
+
+#ifdef __GNUC__
+__attribute__((constructor)) static void CrcKernelInit(void) {
+  for (int kernel = kNumCrcKernel - 1; kernel >= 0; --kernel) {
+    if (CrcSetKernel((CrcKernel)kernel)) {
+      return;
+    }
+  }
+}
+#endif
+
+CrcKernel CrcGetKernel(void) { return (CrcKernel)(g_crc_kernel - kCrcKernels); }
+
+const char *CrcKernelName(CrcKernel kernel) {
+  if (kernel < 0 || kernel >= kNumCrcKernel) {
+    return "unknown";
+  }
+  return kCrcKernels[kernel].name;
+}
+
+bool CrcKernelSupported(CrcKernel kernel) {
+  return kernel >= 0 && kernel < kNumCrcKernel && kCrcKernels[kernel].supported();
+}
+
+bool CrcSetKernel(CrcKernel kernel) {
+  if (!CrcKernelSupported(kernel)) {
+    return false;
+  }
+  g_crc_kernel = &kCrcKernels[kernel];
+  return true;
+}
+
+static double CrcSeconds(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+CrcKernel CrcAutotune(const Crc32Info *info) {
+  static const int kRounds = 8;
+  uint8_t buf[16384];
+  for (size_t i = 0; i < sizeof(buf); ++i) {
+    buf[i] = (uint8_t)(i * 131 + (i >> 8));
+  }
+
+  CrcKernel best = CrcGetKernel();
+  double best_time = -1.0;
+  volatile uint32_t sink = 0;
+
+  for (int kernel = 0; kernel < kNumCrcKernel; ++kernel) {
+    if (!CrcKernelSupported((CrcKernel)kernel)) {
+      continue;
+    }
+
+    // Best of several rounds to reject preemption and cold caches.
+    double time = 0.0;
+    for (int round = 0; round < kRounds; ++round) {
+      const double start = CrcSeconds();
+      sink = kCrcKernels[kernel].seq32(info, buf, sizeof(buf), sink);
+      const double elapsed = CrcSeconds() - start;
+      if (round == 0 || elapsed < time) {
+        time = elapsed;
+      }
+    }
+
+    if (best_time < 0.0 || time < best_time) {
+      best = (CrcKernel)kernel;
+      best_time = time;
+    }
+  }
+
+  CrcSetKernel(best);
+  return best;
+}
+
+// Multiply "a" by "b" modulo the "bits" wide polynomial "poly", all in the CRC's bit order.
+static uint32_t CrcMultiplyModP(uint32_t a, uint32_t b, uint32_t poly, unsigned bits,
+                                bool lsb_first) {
+  const uint32_t top = (uint32_t)1 << (bits - 1);
+  uint32_t product = 0;
+
+  if (lsb_first) {
+    // Bit (bits - 1) is x^0.
+    for (uint32_t m = top; m; m >>= 1) {
+      if (a & m) {
+        product ^= b;
+      }
+      b = (b & 1) ? (b >> 1) ^ poly : b >> 1;
+    }
+    return product;
+  }
+
+  const uint32_t mask = top | (top - 1);
+  for (uint32_t m = 1; m & mask; m <<= 1) {
+    if (a & m) {
+      product ^= b;
+    }
+    b = ((b << 1) & mask) ^ ((b & top) ? poly : 0);
+  }
+  return product;
+}
+
+// CRC of A || B from the CRCs of A and B:
+// crc(A || B) = (crc(A) ^ final_xor ^ initial_crc) * x^(8 * len(B)) mod P ^ crc(B).
+static uint32_t CrcCombine(uint32_t crc_a, uint32_t crc_b, size_t len_b, uint32_t initial_crc,
+                           uint32_t final_xor, uint32_t poly, unsigned bits, bool lsb_first) {
+  const uint32_t one = lsb_first ? (uint32_t)1 << (bits - 1) : 1;
+  const uint32_t x = lsb_first ? one >> 1 : 2;
+
+  // x^(8 * len_b) by square and multiply.
+  uint32_t square = CrcMultiplyModP(x, x, poly, bits, lsb_first);
+  square = CrcMultiplyModP(square, square, poly, bits, lsb_first);
+  square = CrcMultiplyModP(square, square, poly, bits, lsb_first);
+  uint32_t shift = one;
+  for (; len_b; len_b >>= 1) {
+    if (len_b & 1) {
+      shift = CrcMultiplyModP(shift, square, poly, bits, lsb_first);
+    }
+    square = CrcMultiplyModP(square, square, poly, bits, lsb_first);
+  }
+
+  const uint32_t reg_a = crc_a ^ final_xor ^ initial_crc;
+  return CrcMultiplyModP(reg_a, shift, poly, bits, lsb_first) ^ crc_b;
+}
 
 uint8_t Crc8Update(const Crc8Info *info, uint8_t crc, uint8_t byte) {
   const uint8_t idx = crc ^ byte;
@@ -20,6 +294,13 @@ uint8_t Crc8Block(const Crc8Info *info, const uint8_t *input, size_t len) {
   return info->final_xor ^ Crc8Seq(info, input, len, info->initial_crc);
 }
 
+uint8_t Crc8Combine(const Crc8Info *info, uint8_t crc_a, uint8_t crc_b, size_t len_b) {
+  // The table entry for the lowest order bit (0x80 reflected, 0x01 otherwise) is the polynomial.
+  const uint8_t poly = info->lsb_first ? info->table[0x80] : info->table[0x01];
+  return (uint8_t)CrcCombine(crc_a, crc_b, len_b, info->initial_crc, info->final_xor, poly, 8,
+                             info->lsb_first);
+}
+
 uint16_t Crc16Update(const Crc16Info *info, uint16_t crc, uint8_t byte) {
   if (info->lsb_first) {
     const uint8_t idx = crc ^ byte;
@@ -30,17 +311,186 @@ uint16_t Crc16Update(const Crc16Info *info, uint16_t crc, uint8_t byte) {
   return (crc << 8) ^ info->table[idx];
 }
 
-uint16_t Crc16Seq(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc) {
+uint16_t Crc16SeqTable(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc) {
   for (size_t i = 0; i < len; ++i) {
     crc = Crc16Update(info, crc, input[i]);
   }
   return crc;
 }
 
+// Process "blocks" blocks of "slices" bytes.  Table k of "table" is the CRC of a byte followed by k
+// zero bytes, so each byte of a block is looked up independently of the others.
+static inline uint16_t Crc16Sliced(const uint16_t *table, size_t slices, bool lsb_first,
+                                   const uint8_t *input, size_t blocks, uint16_t crc) {
+  for (size_t i = 0; i < blocks; ++i) {
+    // Order CRC bytes as they line up with the input bytes.
+    const uint16_t reg = lsb_first ? crc : CrcByteSwap16(crc);
+    crc = 0;
+#pragma GCC unroll 16
+    for (size_t j = 0; j < slices; ++j) {
+      const uint8_t byte = j < 2 ? input[j] ^ (uint8_t)(reg >> (8 * j)) : input[j];
+      crc ^= table[256 * (slices - 1 - j) + byte];
+    }
+    input += slices;
+  }
+  return crc;
+}
+
+uint16_t Crc16SeqSliced(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc) {
+  const size_t slices = info->slices;
+  const size_t blocks = slices >= 4 ? len / slices : 0;
+
+  // Constant slice counts let the compiler unroll the inner loop.
+  switch (slices) {
+    case 4:
+      crc = Crc16Sliced(info->table, 4, info->lsb_first, input, blocks, crc);
+      break;
+    case 8:
+      crc = Crc16Sliced(info->table, 8, info->lsb_first, input, blocks, crc);
+      break;
+    case 16:
+      crc = Crc16Sliced(info->table, 16, info->lsb_first, input, blocks, crc);
+      break;
+    default:
+      crc = Crc16Sliced(info->table, slices, info->lsb_first, input, blocks, crc);
+      break;
+  }
+
+  const size_t done = blocks * slices;
+  return Crc16SeqTable(info, input + done, len - done, crc);
+}
+
+uint16_t Crc16SeqClmul(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc) {
+#ifdef CRC_X86_CLMUL
+  if (info->clmul && len >= kCrcClmulMinLen && CrcHaveClmul()) {
+    crc = (uint16_t)CrcClmul(info->clmul, 16, info->lsb_first, input, len, crc);
+    input += len & ~(size_t)15;
+    len &= 15;
+  }
+#endif
+
+  return Crc16SeqSliced(info, input, len, crc);
+}
+
+uint16_t Crc16Seq(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc) {
+  if (len < kCrcKernelMinLen) {
+    return Crc16SeqTable(info, input, len, crc);
+  }
+  return g_crc_kernel->seq16(info, input, len, crc);
+}
+
 uint16_t Crc16Block(const Crc16Info *info, const uint8_t *input, size_t len) {
   return info->final_xor ^ Crc16Seq(info, input, len, info->initial_crc);
 }
 
+uint16_t Crc16Combine(const Crc16Info *info, uint16_t crc_a, uint16_t crc_b, size_t len_b) {
+  // The table entry for the lowest order bit (0x80 reflected, 0x01 otherwise) is the polynomial.
+  const uint16_t poly = info->lsb_first ? info->table[0x80] : info->table[0x01];
+  return (uint16_t)CrcCombine(crc_a, crc_b, len_b, info->initial_crc, info->final_xor, poly, 16,
+                              info->lsb_first);
+}
+
+// Advance every lane by "blocks" blocks of "slices" bytes (single bytes if slices < 4).
+static inline void Crc16BatchLanes(const Crc16Info *info, size_t slices, CrcBatchLane *lanes,
+                                    size_t blocks) {
+  // Keep the lanes in registers so the CRC dependency chains do not pass through memory.
+  uint16_t crc[CRC_BATCH_LANES];
+  const uint8_t *input[CRC_BATCH_LANES];
+  for (size_t l = 0; l < CRC_BATCH_LANES; ++l) {
+    crc[l] = (uint16_t)lanes[l].crc;
+    input[l] = lanes[l].input;
+  }
+
+  const size_t step = slices < 4 ? 1 : slices;
+  for (size_t i = 0; i < blocks; ++i) {
+#pragma GCC unroll 4
+    for (size_t l = 0; l < CRC_BATCH_LANES; ++l) {
+      if (slices < 4) {
+        crc[l] = Crc16Update(info, crc[l], input[l][0]);
+      } else {
+        crc[l] = Crc16Sliced(info->table, slices, info->lsb_first, input[l], 1, crc[l]);
+      }
+      input[l] += step;
+    }
+  }
+
+  for (size_t l = 0; l < CRC_BATCH_LANES; ++l) {
+    lanes[l].crc = crc[l];
+    lanes[l].input = input[l];
+    lanes[l].len -= blocks * step;
+  }
+}
+
+// Carry-less multiply folding beats interleaved table lookups once it applies, so those inputs are
+// computed directly.  Returns the index of the next input for the lanes.
+static size_t Crc16BatchSkipDirect(const Crc16Info *info, const uint8_t *const *inputs,
+                                   const size_t *lens, size_t n, size_t next, uint16_t *crcs) {
+  if (g_crc_kernel != &kCrcKernels[kCrcKernelClmul] || !info->clmul) {
+    return next;
+  }
+  for (; next < n && lens[next] >= kCrcClmulMinLen; ++next) {
+    crcs[next] = Crc16Block(info, inputs[next], lens[next]);
+  }
+  return next;
+}
+
+void Crc16BlockBatch(const Crc16Info *info, const uint8_t *const *inputs, const size_t *lens,
+                     size_t n, uint16_t *crcs) {
+  const size_t slices = info->slices >= 4 ? info->slices : 1;
+  CrcBatchLane lanes[CRC_BATCH_LANES];
+  size_t active = 0;
+  size_t next = 0;
+
+  next = Crc16BatchSkipDirect(info, inputs, lens, n, next, crcs);
+  for (; active < CRC_BATCH_LANES && next < n; ++active) {
+    lanes[active] = (CrcBatchLane){inputs[next], lens[next], next, info->initial_crc};
+    next = Crc16BatchSkipDirect(info, inputs, lens, n, next + 1, crcs);
+  }
+
+  while (active == CRC_BATCH_LANES) {
+    size_t min_len = lanes[0].len;
+    for (size_t l = 1; l < CRC_BATCH_LANES; ++l) {
+      min_len = lanes[l].len < min_len ? lanes[l].len : min_len;
+    }
+
+    // Constant slice counts let the compiler unroll the inner loop.
+    switch (slices) {
+      case 8:
+        Crc16BatchLanes(info, 8, lanes, min_len / 8);
+        break;
+      case 16:
+        Crc16BatchLanes(info, 16, lanes, min_len / 16);
+        break;
+      default:
+        Crc16BatchLanes(info, slices, lanes, min_len / slices);
+        break;
+    }
+
+    // Finish lanes with less than a block left and refill them with the next input.
+    for (size_t l = 0; l < active;) {
+      CrcBatchLane *lane = &lanes[l];
+      if (lane->len >= slices) {
+        ++l;
+        continue;
+      }
+
+      const uint16_t crc = Crc16SeqTable(info, lane->input, lane->len, (uint16_t)lane->crc);
+      crcs[lane->index] = info->final_xor ^ crc;
+      if (next < n) {
+        *lane = (CrcBatchLane){inputs[next], lens[next], next, info->initial_crc};
+        next = Crc16BatchSkipDirect(info, inputs, lens, n, next + 1, crcs);
+      } else {
+        *lane = lanes[--active];
+      }
+    }
+  }
+
+  for (size_t l = 0; l < active; ++l) {
+    crcs[lanes[l].index] =
+        info->final_xor ^ Crc16Seq(info, lanes[l].input, lanes[l].len, (uint16_t)lanes[l].crc);
+  }
+}
+
 uint32_t Crc32Update(const Crc32Info *info, uint32_t crc, uint8_t byte) {
   if (info->lsb_first) {
     const uint8_t idx = crc ^ byte;
@@ -51,13 +501,182 @@ uint32_t Crc32Update(const Crc32Info *info, uint32_t crc, uint8_t byte) {
   return (crc << 8) ^ info->table[idx];
 }
 
-uint32_t Crc32Seq(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc) {
+uint32_t Crc32SeqTable(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc) {
   for (size_t i = 0; i < len; ++i) {
     crc = Crc32Update(info, crc, input[i]);
   }
   return crc;
 }
 
+// Process "blocks" blocks of "slices" bytes.  Table k of "table" is the CRC of a byte followed by k
+// zero bytes, so each byte of a block is looked up independently of the others.
+static inline uint32_t Crc32Sliced(const uint32_t *table, size_t slices, bool lsb_first,
+                                   const uint8_t *input, size_t blocks, uint32_t crc) {
+  for (size_t i = 0; i < blocks; ++i) {
+    // Order CRC bytes as they line up with the input bytes.
+    const uint32_t reg = lsb_first ? crc : CrcByteSwap32(crc);
+    crc = 0;
+#pragma GCC unroll 16
+    for (size_t j = 0; j < slices; ++j) {
+      const uint8_t byte = j < 4 ? input[j] ^ (uint8_t)(reg >> (8 * j)) : input[j];
+      crc ^= table[256 * (slices - 1 - j) + byte];
+    }
+    input += slices;
+  }
+  return crc;
+}
+
+uint32_t Crc32SeqSliced(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc) {
+  const size_t slices = info->slices;
+  const size_t blocks = slices >= 4 ? len / slices : 0;
+
+  // Constant slice counts let the compiler unroll the inner loop.
+  switch (slices) {
+    case 4:
+      crc = Crc32Sliced(info->table, 4, info->lsb_first, input, blocks, crc);
+      break;
+    case 8:
+      crc = Crc32Sliced(info->table, 8, info->lsb_first, input, blocks, crc);
+      break;
+    case 16:
+      crc = Crc32Sliced(info->table, 16, info->lsb_first, input, blocks, crc);
+      break;
+    default:
+      crc = Crc32Sliced(info->table, slices, info->lsb_first, input, blocks, crc);
+      break;
+  }
+
+  const size_t done = blocks * slices;
+  return Crc32SeqTable(info, input + done, len - done, crc);
+}
+
+uint32_t Crc32SeqClmul(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc) {
+#ifdef CRC_X86_CLMUL
+  if (info->clmul && len >= kCrcClmulMinLen && CrcHaveClmul()) {
+    crc = (uint32_t)CrcClmul(info->clmul, 32, info->lsb_first, input, len, crc);
+    input += len & ~(size_t)15;
+    len &= 15;
+  }
+#endif
+
+  return Crc32SeqSliced(info, input, len, crc);
+}
+
+uint32_t Crc32Seq(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc) {
+  if (len < kCrcKernelMinLen) {
+    return Crc32SeqTable(info, input, len, crc);
+  }
+  return g_crc_kernel->seq32(info, input, len, crc);
+}
+
 uint32_t Crc32Block(const Crc32Info *info, const uint8_t *input, size_t len) {
   return info->final_xor ^ Crc32Seq(info, input, len, info->initial_crc);
 }
+
+uint32_t Crc32Combine(const Crc32Info *info, uint32_t crc_a, uint32_t crc_b, size_t len_b) {
+  // The table entry for the lowest order bit (0x80 reflected, 0x01 otherwise) is the polynomial.
+  const uint32_t poly = info->lsb_first ? info->table[0x80] : info->table[0x01];
+  return (uint32_t)CrcCombine(crc_a, crc_b, len_b, info->initial_crc, info->final_xor, poly, 32,
+                              info->lsb_first);
+}
+
+// Advance every lane by "blocks" blocks of "slices" bytes (single bytes if slices < 4).
+static inline void Crc32BatchLanes(const Crc32Info *info, size_t slices, CrcBatchLane *lanes,
+                                    size_t blocks) {
+  // Keep the lanes in registers so the CRC dependency chains do not pass through memory.
+  uint32_t crc[CRC_BATCH_LANES];
+  const uint8_t *input[CRC_BATCH_LANES];
+  for (size_t l = 0; l < CRC_BATCH_LANES; ++l) {
+    crc[l] = (uint32_t)lanes[l].crc;
+    input[l] = lanes[l].input;
+  }
+
+  const size_t step = slices < 4 ? 1 : slices;
+  for (size_t i = 0; i < blocks; ++i) {
+#pragma GCC unroll 4
+    for (size_t l = 0; l < CRC_BATCH_LANES; ++l) {
+      if (slices < 4) {
+        crc[l] = Crc32Update(info, crc[l], input[l][0]);
+      } else {
+        crc[l] = Crc32Sliced(info->table, slices, info->lsb_first, input[l], 1, crc[l]);
+      }
+      input[l] += step;
+    }
+  }
+
+  for (size_t l = 0; l < CRC_BATCH_LANES; ++l) {
+    lanes[l].crc = crc[l];
+    lanes[l].input = input[l];
+    lanes[l].len -= blocks * step;
+  }
+}
+
+// Carry-less multiply folding beats interleaved table lookups once it applies, so those inputs are
+// computed directly.  Returns the index of the next input for the lanes.
+static size_t Crc32BatchSkipDirect(const Crc32Info *info, const uint8_t *const *inputs,
+                                   const size_t *lens, size_t n, size_t next, uint32_t *crcs) {
+  if (g_crc_kernel != &kCrcKernels[kCrcKernelClmul] || !info->clmul) {
+    return next;
+  }
+  for (; next < n && lens[next] >= kCrcClmulMinLen; ++next) {
+    crcs[next] = Crc32Block(info, inputs[next], lens[next]);
+  }
+  return next;
+}
+
+void Crc32BlockBatch(const Crc32Info *info, const uint8_t *const *inputs, const size_t *lens,
+                     size_t n, uint32_t *crcs) {
+  const size_t slices = info->slices >= 4 ? info->slices : 1;
+  CrcBatchLane lanes[CRC_BATCH_LANES];
+  size_t active = 0;
+  size_t next = 0;
+
+  next = Crc32BatchSkipDirect(info, inputs, lens, n, next, crcs);
+  for (; active < CRC_BATCH_LANES && next < n; ++active) {
+    lanes[active] = (CrcBatchLane){inputs[next], lens[next], next, info->initial_crc};
+    next = Crc32BatchSkipDirect(info, inputs, lens, n, next + 1, crcs);
+  }
+
+  while (active == CRC_BATCH_LANES) {
+    size_t min_len = lanes[0].len;
+    for (size_t l = 1; l < CRC_BATCH_LANES; ++l) {
+      min_len = lanes[l].len < min_len ? lanes[l].len : min_len;
+    }
+
+    // Constant slice counts let the compiler unroll the inner loop.
+    switch (slices) {
+      case 8:
+        Crc32BatchLanes(info, 8, lanes, min_len / 8);
+        break;
+      case 16:
+        Crc32BatchLanes(info, 16, lanes, min_len / 16);
+        break;
+      default:
+        Crc32BatchLanes(info, slices, lanes, min_len / slices);
+        break;
+    }
+
+    // Finish lanes with less than a block left and refill them with the next input.
+    for (size_t l = 0; l < active;) {
+      CrcBatchLane *lane = &lanes[l];
+      if (lane->len >= slices) {
+        ++l;
+        continue;
+      }
+
+      const uint32_t crc = Crc32SeqTable(info, lane->input, lane->len, (uint32_t)lane->crc);
+      crcs[lane->index] = info->final_xor ^ crc;
+      if (next < n) {
+        *lane = (CrcBatchLane){inputs[next], lens[next], next, info->initial_crc};
+        next = Crc32BatchSkipDirect(info, inputs, lens, n, next + 1, crcs);
+      } else {
+        *lane = lanes[--active];
+      }
+    }
+  }
+
+  for (size_t l = 0; l < active; ++l) {
+    crcs[lanes[l].index] =
+        info->final_xor ^ Crc32Seq(info, lanes[l].input, lanes[l].len, (uint32_t)lanes[l].crc);
+  }
+}
@@ -4,6 +4,23 @@
 #include <stddef.h>
 #include <stdint.h>
 
+typedef enum {
+  kCrcKernelForceSigned = -1,
+  kCrcKernelTable,  // Byte at a time table lookup.
+  kCrcKernelSliced,  // Slicing-by-N tables, see Crc*Info.slices.
+  kCrcKernelClmul,  // PCLMULQDQ folding, see Crc*Info.clmul.
+  kNumCrcKernel
+} CrcKernel;
+
+// Carry-less multiply (PCLMULQDQ) folding constants generated by gen_crc_table.py.  Each entry is a
+// {low lane, high lane} multiplier pair for the CRC scaled to 32 bits.
+typedef struct {
+  uint64_t fold_512[2];  // Fold 128 bits forward by 512 bits.
+  uint64_t fold_128[2];  // Fold 128 bits forward by 128 bits.
+  uint64_t reduce[2];  // Reduce 128 bits to 64 bits.
+  uint64_t barrett[2];  // Barrett reduction {mu, polynomial}.
+} CrcClmulInfo;
+
 typedef struct {
   const uint8_t *table;  // 256 element CRC table.
   uint8_t initial_crc;  // Initial CRC value.
@@ -12,27 +29,65 @@ typedef struct {
 } Crc8Info;
 
 typedef struct {
-  const uint16_t *table;  // 256 element CRC table.
+  const uint16_t *table;  // 256 * slices element CRC table.
   uint16_t initial_crc;  // Initial CRC value.
   uint16_t final_xor;  // Value of successful CRC.
   bool lsb_first;  // Input and output reflected?
+  uint8_t slices;  // Number of 256 element tables for slicing-by-N (1, 4, 8, or 16).
+  const CrcClmulInfo *clmul;  // Carry-less multiply constants or NULL.
 } Crc16Info;
 
 typedef struct {
-  const uint32_t *table;  // 256 element CRC table.
+  const uint32_t *table;  // 256 * slices element CRC table.
   uint32_t initial_crc;  // Initial CRC value.
   uint32_t final_xor;  // Value of successful CRC.
   bool lsb_first;  // Input and output reflected?
+  uint8_t slices;  // Number of 256 element tables for slicing-by-N (1, 4, 8, or 16).
+  const CrcClmulInfo *clmul;  // Carry-less multiply constants or NULL.
 } Crc32Info;
 
+// Crc*Combine returns the CRC of A || B given crc_a = Crc*Block(A), crc_b = Crc*Block(B) and
+// len_b = length of B.
+
 uint8_t Crc8Update(const Crc8Info *info, uint8_t crc, uint8_t byte);
 uint8_t Crc8Seq(const Crc8Info *info, const uint8_t *input, size_t len, uint8_t crc);
 uint8_t Crc8Block(const Crc8Info *info, const uint8_t *input, size_t len);
+uint8_t Crc8Combine(const Crc8Info *info, uint8_t crc_a, uint8_t crc_b, size_t len_b);
 
 uint16_t Crc16Update(const Crc16Info *info, uint16_t crc, uint8_t byte);
 uint16_t Crc16Seq(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc);
+uint16_t Crc16SeqTable(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc);
+uint16_t Crc16SeqSliced(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc);
+uint16_t Crc16SeqClmul(const Crc16Info *info, const uint8_t *input, size_t len, uint16_t crc);
 uint16_t Crc16Block(const Crc16Info *info, const uint8_t *input, size_t len);
+uint16_t Crc16Combine(const Crc16Info *info, uint16_t crc_a, uint16_t crc_b, size_t len_b);
+void Crc16BlockBatch(const Crc16Info *info, const uint8_t *const *inputs, const size_t *lens,
+                     size_t n, uint16_t *crcs);
 
 uint32_t Crc32Update(const Crc32Info *info, uint32_t crc, uint8_t byte);
 uint32_t Crc32Seq(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc);
+uint32_t Crc32SeqTable(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc);
+uint32_t Crc32SeqSliced(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc);
+uint32_t Crc32SeqClmul(const Crc32Info *info, const uint8_t *input, size_t len, uint32_t crc);
 uint32_t Crc32Block(const Crc32Info *info, const uint8_t *input, size_t len);
+uint32_t Crc32Combine(const Crc32Info *info, uint32_t crc_a, uint32_t crc_b, size_t len_b);
+void Crc32BlockBatch(const Crc32Info *info, const uint8_t *const *inputs, const size_t *lens,
+                     size_t n, uint32_t *crcs);
+
+// Kernel used by Crc16Seq and Crc32Seq on long inputs.  Defaults to the fastest kernel the CPU
+// supports, detected once at load time.
+CrcKernel CrcGetKernel(void);
+
+// Human readable kernel name for logging.
+const char *CrcKernelName(CrcKernel kernel);
+
+// Whether "kernel" can run on this CPU.
+bool CrcKernelSupported(CrcKernel kernel);
+
+// Select "kernel".  Returns false and keeps the current kernel if it is unsupported.  Not safe to
+// call concurrently with CRC calculations; intended for startup.
+bool CrcSetKernel(CrcKernel kernel);
+
+// Time each supported kernel on "info" and select the fastest.  Returns the selected kernel.  Not
+// safe to call concurrently with CRC calculations; intended for startup.
+CrcKernel CrcAutotune(const Crc32Info *info);
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <string_view>
 #include <type_traits>
 
 extern "C" {
@@ -37,6 +39,50 @@ struct CrcConfig<32> {
   using ValueType = uint32_t;
 };
 
+template <int N>
+constexpr uint32_t Reflect(uint32_t value) {
+  uint32_t output = 0;
+  for (int i = 0; i < N; ++i) {
+    output |= ((value >> i) & 0x01) << (N - 1 - i);
+  }
+  return output;
+}
+
+// Same table as gen_crc_table.py without slicing.
+template <int N, uint32_t Poly, bool RefIn>
+constexpr std::array<typename CrcConfig<N>::ValueType, 256> MakeCrcTable() {
+  using Value = typename CrcConfig<N>::ValueType;
+  constexpr uint32_t kTop = uint32_t{1} << (N - 1);
+  constexpr uint32_t kPoly = RefIn ? Reflect<N>(Poly) : Poly;
+
+  std::array<Value, 256> table{};
+  for (uint32_t byte = 0; byte < 256; ++byte) {
+    uint32_t crc = RefIn ? byte : byte << (N - 8);
+    for (int i = 0; i < 8; ++i) {
+      if constexpr (RefIn) {
+        crc = (crc & 0x01) ? (crc >> 1) ^ kPoly : crc >> 1;
+      } else {
+        crc = (crc & kTop) ? (crc << 1) ^ kPoly : crc << 1;
+      }
+    }
+    table[byte] = static_cast<Value>(crc);
+  }
+  return table;
+}
+
+template <int N>
+constexpr typename CrcConfig<N>::InfoType MakeCrcInfo(const typename CrcConfig<N>::ValueType *table,
+                                                      uint32_t initial_crc, uint32_t final_xor,
+                                                      bool lsb_first) {
+  using Value = typename CrcConfig<N>::ValueType;
+  if constexpr (N == 8) {
+    return {table, static_cast<Value>(initial_crc), static_cast<Value>(final_xor), lsb_first};
+  } else {
+    return {table,     static_cast<Value>(initial_crc), static_cast<Value>(final_xor),
+            lsb_first, 1,                               nullptr};
+  }
+}
+
 }  // namespace impl
 
 template <int N>
@@ -57,10 +103,43 @@ class Crc {
     }
   }
 
+  // CRC of A || B given the CRCs of A and B and the length of B.
+  static Value Combine(const Info *info, Value crc_a, Value crc_b, size_t len_b) {
+    if constexpr (N == 8) {
+      return Crc8Combine(info, crc_a, crc_b, len_b);
+    } else if constexpr (N == 16) {
+      return Crc16Combine(info, crc_a, crc_b, len_b);
+    } else if constexpr (N == 32) {
+      return Crc32Combine(info, crc_a, crc_b, len_b);
+    } else {
+      static_assert(impl::always_false<N>::value, "Unsupported number of bits N.");
+    }
+  }
+
+  // crcs[i] = Block(info, inputs[i], lens[i]) for i in [0, n), interleaving independent inputs.
+  static void BlockBatch(const Info *info, const uint8_t *const *inputs, const size_t *lens,
+                         size_t n, Value *crcs) {
+    if constexpr (N == 8) {
+      for (size_t i = 0; i < n; ++i) {
+        crcs[i] = Crc8Block(info, inputs[i], lens[i]);
+      }
+    } else if constexpr (N == 16) {
+      Crc16BlockBatch(info, inputs, lens, n, crcs);
+    } else if constexpr (N == 32) {
+      Crc32BlockBatch(info, inputs, lens, n, crcs);
+    } else {
+      static_assert(impl::always_false<N>::value, "Unsupported number of bits N.");
+    }
+  }
+
   Crc(const Info *info) : info_{info}, crc_{info_->initial_crc} {}
 
   Value Block(const uint8_t *data, size_t len) const { return Block(info_, data, len); }
 
+  void BlockBatch(const uint8_t *const *inputs, const size_t *lens, size_t n, Value *crcs) const {
+    BlockBatch(info_, inputs, lens, n, crcs);
+  }
+
   Value operator()(uint8_t byte) {
     if constexpr (N == 8) {
       crc_ = Crc8Update(info_, crc_, byte);
@@ -91,9 +170,89 @@ class Crc {
 
   void Reset() { crc_ = info_->initial_crc; }
 
+  const Info *GetInfo() const { return info_; }
+
  private:
   const Info *const info_;
   Value crc_;
 };
 
+// CRC fully specified at compile time.  The table is generated by constexpr and every operation is
+// inlined with no branching on the CRC parameters, so CRCs of constant data (e.g. message ID
+// strings) can be evaluated at compile time.  Parameters follow gen_crc_table.py: Poly is
+// unreflected, Init and XorOut are used as is.
+template <int Width, uint32_t Poly, uint32_t Init, uint32_t XorOut, bool RefIn>
+class CrcT {
+ public:
+  using Info = typename impl::CrcConfig<Width>::InfoType;
+  using Value = typename impl::CrcConfig<Width>::ValueType;
+
+  static_assert(Width == 32 || Poly < (uint32_t{1} << Width), "Poly wider than Width.");
+  static_assert(Width == 32 || Init < (uint32_t{1} << Width), "Init wider than Width.");
+  static_assert(Width == 32 || XorOut < (uint32_t{1} << Width), "XorOut wider than Width.");
+
+  static constexpr std::array<Value, 256> kTable = impl::MakeCrcTable<Width, Poly, RefIn>();
+
+  // Table backed Info for use with Crc<Width> and the C API.
+  static constexpr Info kInfo = impl::MakeCrcInfo<Width>(kTable.data(), Init, XorOut, RefIn);
+
+  static constexpr Value Update(Value crc, uint8_t byte) {
+    if constexpr (Width == 8) {
+      return kTable[static_cast<uint8_t>(crc ^ byte)];
+    } else if constexpr (RefIn) {
+      return static_cast<Value>((crc >> 8) ^ kTable[static_cast<uint8_t>(crc ^ byte)]);
+    } else {
+      const uint8_t idx = static_cast<uint8_t>((crc >> (Width - 8)) ^ byte);
+      return static_cast<Value>((crc << 8) ^ kTable[idx]);
+    }
+  }
+
+  static constexpr Value Seq(const uint8_t *data, size_t len, Value crc) {
+    for (size_t i = 0; i < len; ++i) {
+      crc = Update(crc, data[i]);
+    }
+    return crc;
+  }
+
+  static constexpr Value Block(const uint8_t *data, size_t len) {
+    return static_cast<Value>(XorOut ^ Seq(data, len, static_cast<Value>(Init)));
+  }
+
+  static constexpr Value Block(std::string_view str) {
+    Value crc = static_cast<Value>(Init);
+    for (char c : str) {
+      crc = Update(crc, static_cast<uint8_t>(c));
+    }
+    return static_cast<Value>(XorOut ^ crc);
+  }
+
+  static Value Combine(Value crc_a, Value crc_b, size_t len_b) {
+    return Crc<Width>::Combine(&kInfo, crc_a, crc_b, len_b);
+  }
+
+  constexpr CrcT() = default;
+
+  constexpr Value operator()(uint8_t byte) {
+    crc_ = Update(crc_, byte);
+    return static_cast<Value>(XorOut ^ crc_);
+  }
+
+  constexpr Value operator()(const uint8_t *data, size_t len) {
+    crc_ = Seq(data, len, crc_);
+    return static_cast<Value>(XorOut ^ crc_);
+  }
+
+  constexpr void Reset() { crc_ = static_cast<Value>(Init); }
+
+ private:
+  Value crc_ = static_cast<Value>(Init);
+};
+
+using Crc8Darc = CrcT<8, 0x39, 0x00, 0x00, true>;
+using Crc8ICode = CrcT<8, 0x1D, 0xFD, 0x00, false>;
+using Crc16Kermit = CrcT<16, 0x1021, 0x0000, 0x0000, true>;
+using Crc16CcittFalse = CrcT<16, 0x1021, 0xFFFF, 0x0000, false>;
+using Crc32 = CrcT<32, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, true>;
+using Crc32Mpeg2 = CrcT<32, 0x04C11DB7, 0xFFFFFFFF, 0x00000000, false>;
+
 }  // namespace crc
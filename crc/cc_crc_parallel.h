@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "crc/cc_crc.h"
+#include "util/thread_pool.h"
+
+namespace crc {
+
+// Smallest chunk BlockParallel hands to a thread by default.
+inline constexpr size_t kMinParallelChunk = 1 << 20;
+
+// Same result as Crc<N>::Block() but splits the input into chunks of at least min_chunk bytes which
+// are computed on the pool and merged with Crc<N>::Combine().
+template <int N>
+typename Crc<N>::Value BlockParallel(const typename Crc<N>::Info *info, const uint8_t *data,
+                                     size_t len, util::ThreadPool &pool,
+                                     size_t min_chunk = kMinParallelChunk) {
+  using Value = typename Crc<N>::Value;
+  const size_t chunk_len = std::max(min_chunk, (len + pool.Size()) / (pool.Size() + 1));
+  const size_t num_chunks = chunk_len ? (len + chunk_len - 1) / chunk_len : 0;
+  if (num_chunks < 2) {
+    return Crc<N>::Block(info, data, len);
+  }
+
+  std::vector<Value> crcs(num_chunks);
+  pool.ParallelFor(num_chunks, [&](size_t i) {
+    const size_t offset = i * chunk_len;
+    crcs[i] = Crc<N>::Block(info, data + offset, std::min(chunk_len, len - offset));
+  });
+
+  Value crc = crcs[0];
+  for (size_t i = 1; i < num_chunks; ++i) {
+    crc = Crc<N>::Combine(info, crc, crcs[i], std::min(chunk_len, len - i * chunk_len));
+  }
+  return crc;
+}
+
+template <int N>
+typename Crc<N>::Value BlockParallel(const Crc<N> &crc, const uint8_t *data, size_t len,
+                                     util::ThreadPool &pool,
+                                     size_t min_chunk = kMinParallelChunk) {
+  return BlockParallel<N>(crc.GetInfo(), data, len, pool, min_chunk);
+}
+
+}  // namespace crc
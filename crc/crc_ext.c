@@ -0,0 +1,426 @@
+// CPython extension exposing the CRCs of crc/all_crcs.h to py_crc.  Inputs are read in place
+// through the buffer protocol, so bytes, bytearray, memoryview and contiguous numpy arrays are all
+// accepted without a copy.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "crc/all_crcs.h"
+#include "crc/c_crc.h"
+
+// Inputs at least this long are processed with the GIL released so other threads can run.
+static const Py_ssize_t kCrcExtReleaseGilLen = 8192;
+
+// Records per Crc*BlockBatch call by block_many, bounding the input arrays kept on the stack.
+#define CRC_EXT_BATCH 256
+
+typedef struct {
+  PyObject_HEAD
+  const char *name;
+  int bits;
+  const void *info;  // Crc8Info, Crc16Info, or Crc32Info.
+} CrcInfoObject;
+
+typedef struct {
+  const char *name;
+  int bits;
+  const void *info;
+} CrcEntry;
+
+// Records of block_many.  Fixed size records "record_len" bytes long start every "stride" bytes
+// from "base".  Otherwise record i is base[offsets[i]:offsets[i + 1]].
+typedef struct {
+  const uint8_t *base;
+  const uint64_t *offsets;  // NULL for fixed size records.
+  Py_ssize_t stride;
+  size_t record_len;
+  size_t num;
+  size_t total_len;
+} CrcRecords;
+
+#define CRC_ENTRY(bits, name) {#name "Info", bits, &name##Info},
+static const CrcEntry kCrcEntries[] = {ALL_CRCS(CRC_ENTRY)};
+#undef CRC_ENTRY
+
+static uint32_t CrcExtInitial(const CrcInfoObject *self) {
+  switch (self->bits) {
+    case 8:
+      return ((const Crc8Info *)self->info)->initial_crc;
+    case 16:
+      return ((const Crc16Info *)self->info)->initial_crc;
+    default:
+      return ((const Crc32Info *)self->info)->initial_crc;
+  }
+}
+
+static uint32_t CrcExtFinalXor(const CrcInfoObject *self) {
+  switch (self->bits) {
+    case 8:
+      return ((const Crc8Info *)self->info)->final_xor;
+    case 16:
+      return ((const Crc16Info *)self->info)->final_xor;
+    default:
+      return ((const Crc32Info *)self->info)->final_xor;
+  }
+}
+
+static bool CrcExtLsbFirst(const CrcInfoObject *self) {
+  switch (self->bits) {
+    case 8:
+      return ((const Crc8Info *)self->info)->lsb_first;
+    case 16:
+      return ((const Crc16Info *)self->info)->lsb_first;
+    default:
+      return ((const Crc32Info *)self->info)->lsb_first;
+  }
+}
+
+static uint32_t CrcExtUpdate(const CrcInfoObject *self, uint32_t crc, uint8_t byte) {
+  switch (self->bits) {
+    case 8:
+      return Crc8Update(self->info, (uint8_t)crc, byte);
+    case 16:
+      return Crc16Update(self->info, (uint16_t)crc, byte);
+    default:
+      return Crc32Update(self->info, crc, byte);
+  }
+}
+
+static uint32_t CrcExtSeq(const CrcInfoObject *self, const uint8_t *input, size_t len,
+                          uint32_t crc) {
+  switch (self->bits) {
+    case 8:
+      return Crc8Seq(self->info, input, len, (uint8_t)crc);
+    case 16:
+      return Crc16Seq(self->info, input, len, (uint16_t)crc);
+    default:
+      return Crc32Seq(self->info, input, len, crc);
+  }
+}
+
+static uint32_t CrcExtBlock(const CrcInfoObject *self, const uint8_t *input, size_t len) {
+  switch (self->bits) {
+    case 8:
+      return Crc8Block(self->info, input, len);
+    case 16:
+      return Crc16Block(self->info, input, len);
+    default:
+      return Crc32Block(self->info, input, len);
+  }
+}
+
+static uint32_t CrcExtCombine(const CrcInfoObject *self, uint32_t crc_a, uint32_t crc_b,
+                              size_t len_b) {
+  switch (self->bits) {
+    case 8:
+      return Crc8Combine(self->info, (uint8_t)crc_a, (uint8_t)crc_b, len_b);
+    case 16:
+      return Crc16Combine(self->info, (uint16_t)crc_a, (uint16_t)crc_b, len_b);
+    default:
+      return Crc32Combine(self->info, crc_a, crc_b, len_b);
+  }
+}
+
+static void CrcExtRecord(const CrcRecords *records, size_t i, const uint8_t **input, size_t *len) {
+  if (records->offsets) {
+    *input = records->base + records->offsets[i];
+    *len = (size_t)(records->offsets[i + 1] - records->offsets[i]);
+  } else {
+    *input = records->base + (Py_ssize_t)i * records->stride;
+    *len = records->record_len;
+  }
+}
+
+// Store the CRC of each record in "crcs", native endian values of bits / 8 bytes.
+static void CrcExtBlockMany(const CrcInfoObject *self, const CrcRecords *records, uint8_t *crcs) {
+  const uint8_t *inputs[CRC_EXT_BATCH];
+  size_t lens[CRC_EXT_BATCH];
+  const size_t width = (size_t)self->bits / 8;
+  for (size_t start = 0; start < records->num; start += CRC_EXT_BATCH) {
+    const size_t n = records->num - start < CRC_EXT_BATCH ? records->num - start : CRC_EXT_BATCH;
+    for (size_t i = 0; i < n; ++i) {
+      CrcExtRecord(records, start + i, &inputs[i], &lens[i]);
+    }
+
+    uint8_t *output = crcs + start * width;
+    if (self->bits == 8) {
+      for (size_t i = 0; i < n; ++i) {
+        output[i] = Crc8Block(self->info, inputs[i], lens[i]);
+      }
+    } else if (self->bits == 16) {
+      uint16_t batch[CRC_EXT_BATCH];
+      Crc16BlockBatch(self->info, inputs, lens, n, batch);
+      memcpy(output, batch, n * width);
+    } else {
+      uint32_t batch[CRC_EXT_BATCH];
+      Crc32BlockBatch(self->info, inputs, lens, n, batch);
+      memcpy(output, batch, n * width);
+    }
+  }
+}
+
+// Fixed size records: the rows of a 2D buffer or the items of a 1D buffer.
+static bool CrcExtFixedRecords(const Py_buffer *data, CrcRecords *records) {
+  if (data->ndim == 1) {
+    records->record_len = (size_t)data->itemsize;
+  } else if (data->ndim == 2 && data->strides[1] == data->itemsize) {
+    records->record_len = (size_t)(data->shape[1] * data->itemsize);
+  } else {
+    PyErr_SetString(PyExc_ValueError,
+                    "Records must be the rows of a 2D array or the items of a 1D array, each "
+                    "contiguous.");
+    return false;
+  }
+  records->base = data->buf;
+  records->stride = data->strides[0];
+  records->num = (size_t)data->shape[0];
+  records->total_len = records->num * records->record_len;
+  return true;
+}
+
+// Variable length records delimited by "offsets", N + 1 native endian 64 bit integers.
+static bool CrcExtOffsetRecords(const Py_buffer *data, const Py_buffer *offsets,
+                                CrcRecords *records) {
+  const char *format = offsets->format ? offsets->format : "B";
+  const char type = format[strlen(format) - 1];
+  if (offsets->itemsize != sizeof(uint64_t) || !strchr("QqLl", type) || format[0] == '>' ||
+      format[0] == '!' || offsets->len < offsets->itemsize) {
+    PyErr_SetString(PyExc_ValueError, "offsets must hold at least one 64 bit integer.");
+    return false;
+  }
+
+  records->base = data->buf;
+  records->offsets = offsets->buf;
+  records->num = (size_t)(offsets->len / offsets->itemsize) - 1;
+  for (size_t i = 0; i < records->num; ++i) {
+    if (records->offsets[i] > records->offsets[i + 1]) {
+      PyErr_SetString(PyExc_ValueError, "offsets must not decrease.");
+      return false;
+    }
+  }
+  if (records->offsets[records->num] > (uint64_t)data->len) {
+    PyErr_SetString(PyExc_ValueError, "offsets exceed data.");
+    return false;
+  }
+  records->total_len = (size_t)(records->offsets[records->num] - records->offsets[0]);
+  return true;
+}
+
+static PyObject *CrcInfoUpdate(CrcInfoObject *self, PyObject *args) {
+  unsigned int crc;
+  unsigned char byte;
+  if (!PyArg_ParseTuple(args, "Ib:update", &crc, &byte)) {
+    return NULL;
+  }
+  return PyLong_FromUnsignedLong(CrcExtUpdate(self, crc, byte));
+}
+
+static PyObject *CrcInfoSeq(CrcInfoObject *self, PyObject *args) {
+  Py_buffer input;
+  unsigned int crc;
+  if (!PyArg_ParseTuple(args, "y*I:seq", &input, &crc)) {
+    return NULL;
+  }
+  PyThreadState *thread = input.len >= kCrcExtReleaseGilLen ? PyEval_SaveThread() : NULL;
+  crc = CrcExtSeq(self, input.buf, (size_t)input.len, crc);
+  if (thread) {
+    PyEval_RestoreThread(thread);
+  }
+  PyBuffer_Release(&input);
+  return PyLong_FromUnsignedLong(crc);
+}
+
+static PyObject *CrcInfoBlock(CrcInfoObject *self, PyObject *arg) {
+  Py_buffer input;
+  if (PyObject_GetBuffer(arg, &input, PyBUF_SIMPLE) < 0) {
+    return NULL;
+  }
+  PyThreadState *thread = input.len >= kCrcExtReleaseGilLen ? PyEval_SaveThread() : NULL;
+  const uint32_t crc = CrcExtBlock(self, input.buf, (size_t)input.len);
+  if (thread) {
+    PyEval_RestoreThread(thread);
+  }
+  PyBuffer_Release(&input);
+  return PyLong_FromUnsignedLong(crc);
+}
+
+static PyObject *CrcInfoCombine(CrcInfoObject *self, PyObject *args) {
+  unsigned int crc_a;
+  unsigned int crc_b;
+  Py_ssize_t len_b;
+  if (!PyArg_ParseTuple(args, "IIn:combine", &crc_a, &crc_b, &len_b)) {
+    return NULL;
+  }
+  if (len_b < 0) {
+    PyErr_SetString(PyExc_ValueError, "len_b must not be negative.");
+    return NULL;
+  }
+  return PyLong_FromUnsignedLong(CrcExtCombine(self, crc_a, crc_b, (size_t)len_b));
+}
+
+static PyObject *CrcInfoBlockMany(CrcInfoObject *self, PyObject *args, PyObject *kwargs) {
+  static char *keywords[] = {"data", "offsets", NULL};
+  PyObject *data_obj;
+  PyObject *offsets_obj = Py_None;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O:block_many", keywords, &data_obj,
+                                   &offsets_obj)) {
+    return NULL;
+  }
+
+  const bool fixed = offsets_obj == Py_None;
+  Py_buffer data;
+  Py_buffer offsets;
+  if (PyObject_GetBuffer(data_obj, &data, fixed ? PyBUF_STRIDES : PyBUF_SIMPLE) < 0) {
+    return NULL;
+  }
+  if (!fixed && PyObject_GetBuffer(offsets_obj, &offsets, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0) {
+    PyBuffer_Release(&data);
+    return NULL;
+  }
+
+  CrcRecords records = {0};
+  PyObject *crcs = NULL;
+  if (fixed ? CrcExtFixedRecords(&data, &records)
+            : CrcExtOffsetRecords(&data, &offsets, &records)) {
+    crcs = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t)(records.num * (size_t)self->bits / 8));
+  }
+  if (crcs) {
+    PyThreadState *thread =
+        records.total_len >= (size_t)kCrcExtReleaseGilLen ? PyEval_SaveThread() : NULL;
+    CrcExtBlockMany(self, &records, (uint8_t *)PyByteArray_AS_STRING(crcs));
+    if (thread) {
+      PyEval_RestoreThread(thread);
+    }
+  }
+
+  PyBuffer_Release(&data);
+  if (!fixed) {
+    PyBuffer_Release(&offsets);
+  }
+  return crcs;
+}
+
+static PyObject *CrcInfoGetName(CrcInfoObject *self, void *closure) {
+  (void)closure;
+  return PyUnicode_FromString(self->name);
+}
+
+static PyObject *CrcInfoGetBits(CrcInfoObject *self, void *closure) {
+  (void)closure;
+  return PyLong_FromLong(self->bits);
+}
+
+static PyObject *CrcInfoGetInitialCrc(CrcInfoObject *self, void *closure) {
+  (void)closure;
+  return PyLong_FromUnsignedLong(CrcExtInitial(self));
+}
+
+static PyObject *CrcInfoGetFinalXor(CrcInfoObject *self, void *closure) {
+  (void)closure;
+  return PyLong_FromUnsignedLong(CrcExtFinalXor(self));
+}
+
+static PyObject *CrcInfoGetLsbFirst(CrcInfoObject *self, void *closure) {
+  (void)closure;
+  return PyBool_FromLong(CrcExtLsbFirst(self));
+}
+
+static PyObject *CrcInfoRepr(CrcInfoObject *self) {
+  return PyUnicode_FromFormat("<crc_ext.Info %s>", self->name);
+}
+
+static PyMethodDef kCrcInfoMethods[] = {
+    {"update", (PyCFunction)CrcInfoUpdate, METH_VARARGS,
+     "update(crc, byte) -> int\n\nUpdate the unfinalized \"crc\" with a single byte."},
+    {"seq", (PyCFunction)CrcInfoSeq, METH_VARARGS,
+     "seq(data, crc) -> int\n\nUpdate the unfinalized \"crc\" with a buffer of bytes."},
+    {"block", (PyCFunction)CrcInfoBlock, METH_O,
+     "block(data) -> int\n\nFinalized CRC of a buffer of bytes."},
+    {"combine", (PyCFunction)CrcInfoCombine, METH_VARARGS,
+     "combine(crc_a, crc_b, len_b) -> int\n\nCRC of A + B given block(A), block(B) and len(B)."},
+    {"block_many", (PyCFunction)(void (*)(void))CrcInfoBlockMany, METH_VARARGS | METH_KEYWORDS,
+     "block_many(data, offsets=None) -> bytearray\n\nFinalized CRC of each record of \"data\", "
+     "interleaving independent records.  Without offsets, records are the rows of a 2D buffer or "
+     "the items of a 1D buffer.  With offsets, N + 1 64 bit integers, record i is "
+     "data[offsets[i]:offsets[i + 1]].  Returns the CRCs as native endian bits / 8 byte values."},
+    {NULL, NULL, 0, NULL},
+};
+
+static PyGetSetDef kCrcInfoGetSet[] = {
+    {"name", (getter)CrcInfoGetName, NULL, "Symbol name, e.g. kCrc16KermitInfo.", NULL},
+    {"bits", (getter)CrcInfoGetBits, NULL, "CRC width.", NULL},
+    {"initial_crc", (getter)CrcInfoGetInitialCrc, NULL, "Initial CRC value.", NULL},
+    {"final_xor", (getter)CrcInfoGetFinalXor, NULL, "Value of successful CRC.", NULL},
+    {"lsb_first", (getter)CrcInfoGetLsbFirst, NULL, "Input and output reflected?", NULL},
+    {NULL, NULL, NULL, NULL, NULL},
+};
+
+static PyTypeObject kCrcInfoType = {
+    PyVarObject_HEAD_INIT(NULL, 0)  // Trailing comma is part of the macro.
+    .tp_name = "crc_ext.Info",
+    .tp_doc = "CRC parameters from crc/all_crcs.h.  Created by lookup().",
+    .tp_basicsize = sizeof(CrcInfoObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_repr = (reprfunc)CrcInfoRepr,
+    .tp_methods = kCrcInfoMethods,
+    .tp_getset = kCrcInfoGetSet,
+};
+
+static PyObject *CrcExtLookup(PyObject *module, PyObject *arg) {
+  (void)module;
+  const char *name = PyUnicode_AsUTF8(arg);
+  if (!name) {
+    return NULL;
+  }
+  for (size_t i = 0; i < sizeof(kCrcEntries) / sizeof(kCrcEntries[0]); ++i) {
+    if (strcmp(kCrcEntries[i].name, name) == 0) {
+      CrcInfoObject *info = PyObject_New(CrcInfoObject, &kCrcInfoType);
+      if (!info) {
+        return NULL;
+      }
+      info->name = kCrcEntries[i].name;
+      info->bits = kCrcEntries[i].bits;
+      info->info = kCrcEntries[i].info;
+      return (PyObject *)info;
+    }
+  }
+  PyErr_Format(PyExc_KeyError, "%s", name);
+  return NULL;
+}
+
+static PyMethodDef kCrcExtMethods[] = {
+    {"lookup", CrcExtLookup, METH_O,
+     "lookup(name) -> Info\n\nInfo for a Crc*Info struct by name, e.g. \"kCrc32Info\".  Raises "
+     "KeyError if there is none."},
+    {NULL, NULL, 0, NULL},
+};
+
+static struct PyModuleDef kCrcExtModule = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "crc_ext",
+    .m_doc = "Native CRC bindings used by py_crc.",
+    .m_size = -1,
+    .m_methods = kCrcExtMethods,
+};
+
+PyMODINIT_FUNC PyInit_crc_ext(void) {
+  if (PyType_Ready(&kCrcInfoType) < 0) {
+    return NULL;
+  }
+  PyObject *module = PyModule_Create(&kCrcExtModule);
+  if (!module) {
+    return NULL;
+  }
+  Py_INCREF(&kCrcInfoType);
+  if (PyModule_AddObject(module, "Info", (PyObject *)&kCrcInfoType) < 0) {
+    Py_DECREF(&kCrcInfoType);
+    Py_DECREF(module);
+    return NULL;
+  }
+  return module;
+}
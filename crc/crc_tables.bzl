@@ -1,6 +1,6 @@
 load("@bazel_skylib//rules:write_file.bzl", "write_file")
 
-def crc_table(name, crc_name, bits, polynomial, initial_crc, final_xor, lsb_first, **kwargs):
+def crc_table(name, crc_name, bits, polynomial, initial_crc, final_xor, lsb_first, slices = 1, **kwargs):
     args = [
         "-b",
         str(bits),
@@ -10,6 +10,8 @@ def crc_table(name, crc_name, bits, polynomial, initial_crc, final_xor, lsb_firs
         str(initial_crc),
         "-x",
         str(final_xor),
+        "-s",
+        str(slices),
         "--header",
         "$(location :{}.h)".format(name),
         "--source",
@@ -42,28 +44,32 @@ def crc_table(name, crc_name, bits, polynomial, initial_crc, final_xor, lsb_firs
         **kwargs
     )
 
-def crc_repo(**kwargs):
-    crcs = [
-        ("crc_8_darc", "kCrc8Darc", 8, 0x39, 0x00, 0x00, True),
-        ("crc_8_i_code", "kCrc8ICode", 8, 0x1D, 0xFD, 0x00, False),
-        ("crc_16_kermit", "kCrc16Kermit", 16, 0x1021, 0x0000, 0x0000, True),
-        ("crc_16_ccitt_false", "kCrc16CcittFalse", 16, 0x1021, 0xFFFF, 0x0000, False),
-        ("crc_32", "kCrc32", 32, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, True),
-        ("crc_32_mpeg_2", "kCrc32Mpeg2", 32, 0x04C11DB7, 0xFFFFFFFF, 0x00000000, False),
-    ]
+_CRCS = [
+    ("crc_8_darc", "kCrc8Darc", 8, 0x39, 0x00, 0x00, True, 1),
+    ("crc_8_i_code", "kCrc8ICode", 8, 0x1D, 0xFD, 0x00, False, 1),
+    ("crc_16_kermit", "kCrc16Kermit", 16, 0x1021, 0x0000, 0x0000, True, 8),
+    ("crc_16_ccitt_false", "kCrc16CcittFalse", 16, 0x1021, 0xFFFF, 0x0000, False, 8),
+    ("crc_32", "kCrc32", 32, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, True, 8),
+    ("crc_32_mpeg_2", "kCrc32Mpeg2", 32, 0x04C11DB7, 0xFFFFFFFF, 0x00000000, False, 8),
+]
 
-    for crc in crcs:
+def crc_repo(**kwargs):
+    for crc in _CRCS:
         crc_table(*crc, **kwargs)
 
-    all_targets = [":" + x[0] for x in crcs]
-    all_srcs = [x[0] + ".c" for x in crcs]
-    all_hdrs = [x[0] + ".h" for x in crcs]
+    all_targets = [":" + x[0] for x in _CRCS]
+    all_hdrs = [x[0] + ".h" for x in _CRCS]
 
     lines = [
         "#pragma once",
         "",
     ]
     lines += ["#include \"crc/{}\"".format(h) for h in all_hdrs]
+    lines += [
+        "",
+        "// Expands X(bits, name) for each CRC above, e.g. X(16, kCrc16Kermit) for kCrc16KermitInfo.",
+        "#define ALL_CRCS(X) {}".format(" ".join(["X({}, {})".format(x[2], x[1]) for x in _CRCS])),
+    ]
 
     write_file(
         name = "all_crcs_gen",
@@ -79,10 +85,31 @@ def crc_repo(**kwargs):
         **kwargs
     )
 
-    native.cc_binary(
-        name = "all_crcs.so",
-        srcs = all_srcs,
-        linkshared = True,
-        deps = ["@//crc:c_crc"],
+# Test only copies of the 16 and 32 bit CRCs with "slices" tables, e.g. crc_32_sliced_4 for
+# kCrc32Sliced4Info, collected in crc_sliced_<slices>.
+def crc_sliced_test_tables(slices, **kwargs):
+    targets = []
+    for name, crc_name, bits, polynomial, initial_crc, final_xor, lsb_first, _ in _CRCS:
+        if bits == 8:
+            continue
+        target = "{}_sliced_{}".format(name, slices)
+        crc_table(
+            target,
+            "{}Sliced{}".format(crc_name, slices),
+            bits,
+            polynomial,
+            initial_crc,
+            final_xor,
+            lsb_first,
+            slices,
+            testonly = True,
+            **kwargs
+        )
+        targets.append(":" + target)
+
+    native.cc_library(
+        name = "crc_sliced_{}".format(slices),
+        testonly = True,
+        deps = targets,
         **kwargs
     )
@@ -67,9 +67,75 @@ def crc_table(bits: int, poly: int, lsb_first: bool) -> list[int]:
   return table
 
 
+def sliced_crc_table(bits: int, poly: int, lsb_first: bool, slices: int) -> list[int]:
+  if slices < 1:
+    raise ValueError('slices must be greater than 0.')
+
+  if slices > 1 and slices * 8 < bits:
+    raise ValueError('slices * 8 must be at least bits.')
+
+  mask = (1 << bits) - 1
+  base = crc_table(bits, poly, lsb_first)
+
+  # Table k is the CRC of a byte followed by k zero bytes.
+  tables = [base]
+  for _ in range(1, slices):
+    prev = tables[-1]
+    if lsb_first:
+      tables.append([(crc >> 8) ^ base[crc & 0xFF] for crc in prev])
+    else:
+      tables.append([((crc << 8) & mask) ^ base[crc >> (bits - 8)] for crc in prev])
+
+  return [x for table in tables for x in table]
+
+
+def _poly_divmod(dividend: int, divisor: int) -> tuple[int, int]:
+  quotient = 0
+  degree = divisor.bit_length() - 1
+  while dividend.bit_length() - 1 >= degree:
+    shift = dividend.bit_length() - 1 - degree
+    quotient |= 1 << shift
+    dividend ^= divisor << shift
+  return quotient, dividend
+
+
+def clmul_constants(bits: int, poly: int, lsb_first: bool) -> dict[str, tuple[int, int]]:
+  '''Carry-less multiply folding and Barrett reduction constants.
+
+  The CRC is scaled to 32 bits (P32 = P * x^(32 - bits)) so one kernel covers every width.  Each
+  entry is a {low lane, high lane} pair of 64 bit multipliers.  MSB first constants are plain
+  remainders.  Reflected constants are bit reversed 64 bit lanes and absorb the extra factor of x
+  PCLMULQDQ introduces for reflected operands.
+  '''
+  if bits < 16 or bits > 32:
+    raise ValueError('bits must be between 16 and 32.')
+
+  poly32 = ((1 << bits) | poly) << (32 - bits)
+
+  def xn(n: int) -> int:
+    return _poly_divmod(1 << n, poly32)[1]
+
+  mu = _poly_divmod(1 << 64, poly32)[0]
+
+  if lsb_first:
+    return {
+        'fold_512': (_reflect(xn(575), 64), _reflect(xn(511), 64)),
+        'fold_128': (_reflect(xn(191), 64), _reflect(xn(127), 64)),
+        'reduce': (_reflect(xn(95), 64), _reflect(xn(63), 64)),
+        'barrett': (_reflect(mu, 64), _reflect(poly32, 64)),
+    }
+
+  return {
+      'fold_512': (xn(512), xn(576)),
+      'fold_128': (xn(128), xn(192)),
+      'reduce': (xn(64), xn(96)),
+      'barrett': (mu, poly32),
+  }
+
+
 def table_str(table: list[int], bits: int) -> str:
   lines = []
-  for i in range(0, 256, 8):
+  for i in range(0, len(table), 8):
     lines.append(', '.join([_hex_fmt(x, bits) for x in table[i:i + 8]]) + ',')
   return '\n'.join(lines)
 
@@ -82,8 +148,26 @@ def _crc_info_name(crc_name: str) -> str:
   return f'{crc_name}Info'
 
 
+def _crc_clmul_name(crc_name: str) -> str:
+  return f'{crc_name}Clmul'
+
+
+def clmul_str(clmul: dict[str, tuple[int, int]]) -> str:
+  lines = []
+  for name, (low, high) in clmul.items():
+    lines.append(f'.{name} = {{{_hex_fmt(low, 64)}, {_hex_fmt(high, 64)}}},')
+  return '\n'.join(lines)
+
+
 def get_source(crc_name: str, table: list[int], bits: int, initial_crc: int, final_xor: int,
-               lsb_first: bool) -> str:
+               lsb_first: bool, clmul: dict[str, tuple[int, int]] | None) -> str:
+  slices = f'\n    .slices = {len(table) // 256},' if bits > 8 else ''
+  clmul_ref = f'\n    .clmul = &{_crc_clmul_name(crc_name)},' if clmul else ''
+  clmul_def = f'''
+const CrcClmulInfo {_crc_clmul_name(crc_name)} = {{
+{textwrap.indent(clmul_str(clmul), '    ')}
+}};
+''' if clmul else ''
   return f'''\
 #include <stdbool.h>
 #include <stdint.h>
@@ -93,17 +177,18 @@ def get_source(crc_name: str, table: list[int], bits: int, initial_crc: int, fin
 const {_data_type(bits)} {_crc_table_name(crc_name)}[{len(table)}] = {{
 {textwrap.indent(table_str(table, bits), '    ')}
 }};
-
+{clmul_def}
 const Crc{bits}Info {_crc_info_name(crc_name)} = {{
     .table = {_crc_table_name(crc_name)},
     .initial_crc = {_hex_fmt(initial_crc, bits)},
     .final_xor = {_hex_fmt(final_xor, bits)},
-    .lsb_first = {'true' if lsb_first else 'false'},
+    .lsb_first = {'true' if lsb_first else 'false'},{slices}{clmul_ref}
 }};
 '''
 
 
-def get_header(crc_name: str, table: list[int], bits: int) -> str:
+def get_header(crc_name: str, table: list[int], bits: int, clmul: bool) -> str:
+  clmul_decl = f'\nextern const CrcClmulInfo {_crc_clmul_name(crc_name)};' if clmul else ''
   return f'''\
 #pragma once
 
@@ -111,7 +196,7 @@ def get_header(crc_name: str, table: list[int], bits: int) -> str:
 
 #include "crc/c_crc.h"
 
-extern const {_data_type(bits)} {_crc_table_name(crc_name)}[{len(table)}];
+extern const {_data_type(bits)} {_crc_table_name(crc_name)}[{len(table)}];{clmul_decl}
 extern const Crc{bits}Info {_crc_info_name(crc_name)};
 '''
 
@@ -129,6 +214,8 @@ def main():
   parser.add_argument('-i', '--initial-crc', type=hex, required=True, help='Initial CRC value.')
   parser.add_argument('-x', '--final-xor', type=hex, required=True, help='Final XOR value.')
   parser.add_argument('--lsb_first', action='store_true', help='LSB first or reflected table.')
+  parser.add_argument('-s', '--slices', type=int, choices=[1, 4, 8, 16], default=1,
+                      help='Number of tables for slicing-by-N.')
   parser.add_argument('--header', help='Header file name to write.')
   parser.add_argument('--source', help='Source file name to write.')
   parser.add_argument('--name', help='Name for C array and info struct.')
@@ -136,7 +223,11 @@ def main():
 
   args = parser.parse_args()
 
-  table = crc_table(args.bits, args.polynomial, args.lsb_first)
+  if args.slices > 1 and args.bits == 8:
+    parser.error('--slices is only supported for 16 and 32 bit CRCs.')
+
+  table = sliced_crc_table(args.bits, args.polynomial, args.lsb_first, args.slices)
+  clmul = clmul_constants(args.bits, args.polynomial, args.lsb_first) if args.bits > 8 else None
 
   write_output = any(x is not None for x in [args.header, args.source, args.name])
   if write_output:
@@ -145,17 +236,19 @@ def main():
 
   if write_output:
     with open(args.header, 'w') as f:
-      f.write(get_header(args.name, table, args.bits))
+      f.write(get_header(args.name, table, args.bits, clmul is not None))
 
     with open(args.source, 'w') as f:
       f.write(
-          get_source(args.name, table, args.bits, args.initial_crc, args.final_xor, args.lsb_first))
+          get_source(args.name, table, args.bits, args.initial_crc, args.final_xor, args.lsb_first,
+                     clmul))
 
   if args.print:
     print('CRC Table')
     print(f'Bits: {args.bits}')
     print(f'Polynomial: {_hex_fmt(args.polynomial, args.bits)}')
     print(f'LSB First (reflected): {args.lsb_first}')
+    print(f'Slices: {args.slices}')
     print('Values:')
     print(table_str(table, args.bits))
 
@@ -4,10 +4,26 @@
 
 #include "crc/all_crcs.h"
 #include "crc/c_crc.h"
+#include "crc/crc_16_ccitt_false_sliced_16.h"
+#include "crc/crc_16_ccitt_false_sliced_4.h"
+#include "crc/crc_16_kermit_sliced_16.h"
+#include "crc/crc_16_kermit_sliced_4.h"
+#include "crc/crc_32_mpeg_2_sliced_16.h"
+#include "crc/crc_32_mpeg_2_sliced_4.h"
+#include "crc/crc_32_sliced_16.h"
+#include "crc/crc_32_sliced_4.h"
 
 static const uint8_t g_check[] = "123456789";
 
-void setUp(void) {}
+static uint8_t g_long[1000];
+
+void setUp(void) {
+  uint32_t x = 1;
+  for (size_t i = 0; i < sizeof(g_long); ++i) {
+    x = x * 1103515245 + 12345;
+    g_long[i] = (uint8_t)(x >> 16);
+  }
+}
 void tearDown(void) {}
 
 static void TestCrc8Darc(void) {
@@ -34,6 +50,189 @@ static void TestCrc32Mpeg2(void) {
   TEST_ASSERT_EQUAL_HEX32(0x0376E6E7, Crc32Block(&kCrc32Mpeg2Info, g_check, sizeof(g_check) - 1));
 }
 
+static void TestCrc16Sliced(void) {
+  const Crc16Info *infos[] = {&kCrc16KermitInfo, &kCrc16CcittFalseInfo};
+  for (size_t i = 0; i < sizeof(infos) / sizeof(infos[0]); ++i) {
+    const Crc16Info *info = infos[i];
+    for (size_t len = 0; len < sizeof(g_long); len += 37) {
+      const uint16_t expected = Crc16SeqTable(info, g_long, len, info->initial_crc);
+      TEST_ASSERT_EQUAL_HEX16(expected, Crc16SeqSliced(info, g_long, len, info->initial_crc));
+      TEST_ASSERT_EQUAL_HEX16(expected ^ info->final_xor, Crc16Block(info, g_long, len));
+    }
+  }
+}
+
+static void TestCrc32Sliced(void) {
+  const Crc32Info *infos[] = {&kCrc32Info, &kCrc32Mpeg2Info};
+  for (size_t i = 0; i < sizeof(infos) / sizeof(infos[0]); ++i) {
+    const Crc32Info *info = infos[i];
+    for (size_t len = 0; len < sizeof(g_long); len += 37) {
+      const uint32_t expected = Crc32SeqTable(info, g_long, len, info->initial_crc);
+      TEST_ASSERT_EQUAL_HEX32(expected, Crc32SeqSliced(info, g_long, len, info->initial_crc));
+      TEST_ASSERT_EQUAL_HEX32(expected ^ info->final_xor, Crc32Block(info, g_long, len));
+    }
+  }
+}
+
+// Every slicing-by-N width, checked against the same CRC's byte at a time table kernel.
+static void TestCrc16SliceCounts(void) {
+  const Crc16Info *infos[][3] = {
+      {&kCrc16KermitInfo, &kCrc16KermitSliced4Info, &kCrc16KermitSliced16Info},
+      {&kCrc16CcittFalseInfo, &kCrc16CcittFalseSliced4Info, &kCrc16CcittFalseSliced16Info},
+  };
+  for (size_t i = 0; i < sizeof(infos) / sizeof(infos[0]); ++i) {
+    TEST_ASSERT_EQUAL_UINT8(4, infos[i][1]->slices);
+    TEST_ASSERT_EQUAL_UINT8(16, infos[i][2]->slices);
+    for (size_t j = 1; j < 3; ++j) {
+      const Crc16Info *info = infos[i][j];
+      for (size_t len = 0; len < sizeof(g_long); len += 37) {
+        const uint16_t expected = Crc16SeqTable(infos[i][0], g_long, len, info->initial_crc);
+        TEST_ASSERT_EQUAL_HEX16(expected, Crc16SeqSliced(info, g_long, len, info->initial_crc));
+        TEST_ASSERT_EQUAL_HEX16(expected ^ info->final_xor, Crc16Block(info, g_long, len));
+      }
+    }
+  }
+}
+
+static void TestCrc32SliceCounts(void) {
+  const Crc32Info *infos[][3] = {
+      {&kCrc32Info, &kCrc32Sliced4Info, &kCrc32Sliced16Info},
+      {&kCrc32Mpeg2Info, &kCrc32Mpeg2Sliced4Info, &kCrc32Mpeg2Sliced16Info},
+  };
+  for (size_t i = 0; i < sizeof(infos) / sizeof(infos[0]); ++i) {
+    TEST_ASSERT_EQUAL_UINT8(4, infos[i][1]->slices);
+    TEST_ASSERT_EQUAL_UINT8(16, infos[i][2]->slices);
+    for (size_t j = 1; j < 3; ++j) {
+      const Crc32Info *info = infos[i][j];
+      for (size_t len = 0; len < sizeof(g_long); len += 37) {
+        const uint32_t expected = Crc32SeqTable(infos[i][0], g_long, len, info->initial_crc);
+        TEST_ASSERT_EQUAL_HEX32(expected, Crc32SeqSliced(info, g_long, len, info->initial_crc));
+        TEST_ASSERT_EQUAL_HEX32(expected ^ info->final_xor, Crc32Block(info, g_long, len));
+      }
+    }
+  }
+}
+
+static void TestCrc16Clmul(void) {
+  const Crc16Info *infos[] = {&kCrc16KermitInfo, &kCrc16CcittFalseInfo};
+  for (size_t i = 0; i < sizeof(infos) / sizeof(infos[0]); ++i) {
+    const Crc16Info *info = infos[i];
+    for (size_t len = 0; len < sizeof(g_long); len += 37) {
+      const uint16_t expected = Crc16SeqTable(info, g_long, len, (uint16_t)len);
+      TEST_ASSERT_EQUAL_HEX16(expected, Crc16SeqClmul(info, g_long, len, (uint16_t)len));
+    }
+  }
+}
+
+static void TestCrc32Clmul(void) {
+  const Crc32Info *infos[] = {&kCrc32Info, &kCrc32Mpeg2Info};
+  for (size_t i = 0; i < sizeof(infos) / sizeof(infos[0]); ++i) {
+    const Crc32Info *info = infos[i];
+    for (size_t len = 0; len < sizeof(g_long); len += 37) {
+      const uint32_t expected = Crc32SeqTable(info, g_long, len, (uint32_t)len);
+      TEST_ASSERT_EQUAL_HEX32(expected, Crc32SeqClmul(info, g_long, len, (uint32_t)len));
+    }
+  }
+}
+
+static void TestCrcKernels(void) {
+  const CrcKernel original = CrcGetKernel();
+  TEST_ASSERT_TRUE(CrcKernelSupported(original));
+  TEST_ASSERT_TRUE(CrcKernelSupported(kCrcKernelTable));
+  TEST_ASSERT_FALSE(CrcKernelSupported(kNumCrcKernel));
+  TEST_ASSERT_FALSE(CrcSetKernel(kNumCrcKernel));
+  TEST_ASSERT_EQUAL_INT(original, CrcGetKernel());
+
+  for (int kernel = 0; kernel < kNumCrcKernel; ++kernel) {
+    TEST_ASSERT_NOT_NULL(CrcKernelName((CrcKernel)kernel));
+    if (!CrcSetKernel((CrcKernel)kernel)) {
+      continue;
+    }
+    TEST_ASSERT_EQUAL_INT(kernel, CrcGetKernel());
+
+    for (size_t len = 0; len < sizeof(g_long); len += 37) {
+      TEST_ASSERT_EQUAL_HEX16(Crc16SeqTable(&kCrc16KermitInfo, g_long, len, 0x1234),
+                              Crc16Seq(&kCrc16KermitInfo, g_long, len, 0x1234));
+      TEST_ASSERT_EQUAL_HEX16(Crc16SeqTable(&kCrc16CcittFalseInfo, g_long, len, 0x1234),
+                              Crc16Seq(&kCrc16CcittFalseInfo, g_long, len, 0x1234));
+      TEST_ASSERT_EQUAL_HEX32(Crc32SeqTable(&kCrc32Info, g_long, len, 0x12345678),
+                              Crc32Seq(&kCrc32Info, g_long, len, 0x12345678));
+      TEST_ASSERT_EQUAL_HEX32(Crc32SeqTable(&kCrc32Mpeg2Info, g_long, len, 0x12345678),
+                              Crc32Seq(&kCrc32Mpeg2Info, g_long, len, 0x12345678));
+    }
+  }
+
+  TEST_ASSERT_TRUE(CrcSetKernel(original));
+}
+
+static void TestCrcAutotune(void) {
+  const CrcKernel original = CrcGetKernel();
+  const CrcKernel kernel = CrcAutotune(&kCrc32Info);
+  TEST_ASSERT_TRUE(CrcKernelSupported(kernel));
+  TEST_ASSERT_EQUAL_INT(kernel, CrcGetKernel());
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926, Crc32Block(&kCrc32Info, g_check, sizeof(g_check) - 1));
+  TEST_ASSERT_TRUE(CrcSetKernel(original));
+}
+
+static void TestCrcCombine(void) {
+  const Crc8Info *infos8[] = {&kCrc8DarcInfo, &kCrc8ICodeInfo};
+  const Crc16Info *infos16[] = {&kCrc16KermitInfo, &kCrc16CcittFalseInfo};
+  const Crc32Info *infos32[] = {&kCrc32Info, &kCrc32Mpeg2Info};
+  for (size_t i = 0; i < 2; ++i) {
+    const uint8_t full8 = Crc8Block(infos8[i], g_long, sizeof(g_long));
+    const uint16_t full16 = Crc16Block(infos16[i], g_long, sizeof(g_long));
+    const uint32_t full32 = Crc32Block(infos32[i], g_long, sizeof(g_long));
+    for (size_t split = 0; split <= sizeof(g_long); split += 37) {
+      const size_t len_b = sizeof(g_long) - split;
+      const uint8_t *b = &g_long[split];
+
+      TEST_ASSERT_EQUAL_HEX8(full8, Crc8Combine(infos8[i], Crc8Block(infos8[i], g_long, split),
+                                                Crc8Block(infos8[i], b, len_b), len_b));
+      TEST_ASSERT_EQUAL_HEX16(full16,
+                              Crc16Combine(infos16[i], Crc16Block(infos16[i], g_long, split),
+                                           Crc16Block(infos16[i], b, len_b), len_b));
+      TEST_ASSERT_EQUAL_HEX32(full32,
+                              Crc32Combine(infos32[i], Crc32Block(infos32[i], g_long, split),
+                                           Crc32Block(infos32[i], b, len_b), len_b));
+    }
+  }
+}
+
+static void TestCrcBatch(void) {
+  enum { kNum = 67 };
+  const uint8_t *inputs[kNum];
+  size_t lens[kNum];
+  for (size_t i = 0; i < kNum; ++i) {
+    // Mix of lengths on both sides of the kernel thresholds, including empty inputs.
+    lens[i] = (i * 97) % 211;
+    inputs[i] = &g_long[(i * 13) % (sizeof(g_long) - 211)];
+  }
+
+  const Crc16Info *infos16[] = {&kCrc16KermitInfo, &kCrc16CcittFalseInfo};
+  const Crc32Info *infos32[] = {&kCrc32Info, &kCrc32Mpeg2Info};
+  const CrcKernel original = CrcGetKernel();
+  for (int kernel = 0; kernel < kNumCrcKernel; ++kernel) {
+    if (!CrcSetKernel((CrcKernel)kernel)) {
+      continue;
+    }
+
+    for (size_t i = 0; i < 2; ++i) {
+      for (size_t n = 0; n <= kNum; n += 11) {
+        uint16_t crcs16[kNum];
+        uint32_t crcs32[kNum];
+        Crc16BlockBatch(infos16[i], inputs, lens, n, crcs16);
+        Crc32BlockBatch(infos32[i], inputs, lens, n, crcs32);
+        for (size_t j = 0; j < n; ++j) {
+          TEST_ASSERT_EQUAL_HEX16(Crc16Block(infos16[i], inputs[j], lens[j]), crcs16[j]);
+          TEST_ASSERT_EQUAL_HEX32(Crc32Block(infos32[i], inputs[j], lens[j]), crcs32[j]);
+        }
+      }
+    }
+  }
+
+  TEST_ASSERT_TRUE(CrcSetKernel(original));
+}
+
 int main(void) {
   UNITY_BEGIN();
   RUN_TEST(TestCrc8Darc);
@@ -42,5 +241,15 @@ int main(void) {
   RUN_TEST(TestCrc16CcittFalse);
   RUN_TEST(TestCrc32);
   RUN_TEST(TestCrc32Mpeg2);
+  RUN_TEST(TestCrc16Sliced);
+  RUN_TEST(TestCrc32Sliced);
+  RUN_TEST(TestCrc16SliceCounts);
+  RUN_TEST(TestCrc32SliceCounts);
+  RUN_TEST(TestCrc16Clmul);
+  RUN_TEST(TestCrc32Clmul);
+  RUN_TEST(TestCrcKernels);
+  RUN_TEST(TestCrcAutotune);
+  RUN_TEST(TestCrcCombine);
+  RUN_TEST(TestCrcBatch);
   return UNITY_END();
 }
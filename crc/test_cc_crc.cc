@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <string>
 #include <variant>
 #include <vector>
 
@@ -93,3 +94,74 @@ TEST_F(CrcFixture, BySeq) {
     EXPECT_EQ(actual, value);
   }
 }
+
+TEST_F(CrcFixture, BlockBatch) {
+  const std::vector<std::string> msgs = {"", "1", "123456789", std::string(100, 'x'),
+                                         std::string(1000, 'y')};
+  std::vector<const uint8_t*> inputs;
+  std::vector<size_t> lens;
+  for (const auto& msg : msgs) {
+    inputs.push_back(reinterpret_cast<const uint8_t*>(msg.data()));
+    lens.push_back(msg.size());
+  }
+
+  int i = 0;
+  for (auto& [crc, value] : crcs_) {
+    SCOPED_TRACE("Crc: " + std::to_string(i++));
+
+    std::visit(
+        [&](auto&& c) {
+          std::vector<std::decay_t<decltype(c(uint8_t{0}))>> crcs(msgs.size());
+          c.BlockBatch(inputs.data(), lens.data(), msgs.size(), crcs.data());
+          for (size_t j = 0; j < msgs.size(); ++j) {
+            EXPECT_EQ(crcs[j], c.Block(inputs[j], lens[j]));
+          }
+          EXPECT_EQ(crcs[2], value);
+        },
+        crc);
+  }
+}
+
+static_assert(Crc8Darc::Block("123456789") == 0x15);
+static_assert(Crc8ICode::Block("123456789") == 0x7E);
+static_assert(Crc16Kermit::Block("123456789") == 0x2189);
+static_assert(Crc16CcittFalse::Block("123456789") == 0x29B1);
+static_assert(Crc32::Block("123456789") == 0xCBF43926);
+static_assert(Crc32Mpeg2::Block("123456789") == 0x0376E6E7);
+
+template <typename T, typename Info>
+static void ExpectMatchesGenerated(const Info *info) {
+  SCOPED_TRACE(std::to_string(sizeof(typename T::Value) * 8) + " bit");
+  for (size_t i = 0; i < T::kTable.size(); ++i) {
+    ASSERT_EQ(T::kTable[i], info->table[i]);
+  }
+
+  std::vector<uint8_t> data(1000);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+
+  using Runtime = Crc<sizeof(typename T::Value) * 8>;
+  EXPECT_EQ(T::Block(data.data(), data.size()), Runtime::Block(info, data.data(), data.size()));
+  EXPECT_EQ(Runtime::Block(&T::kInfo, data.data(), data.size()),
+            Runtime::Block(info, data.data(), data.size()));
+
+  T crc;
+  Runtime runtime(info);
+  for (uint8_t byte : data) {
+    EXPECT_EQ(crc(byte), runtime(byte));
+  }
+  crc.Reset();
+  EXPECT_EQ(crc(data.data(), data.size()), Runtime::Block(info, data.data(), data.size()));
+  EXPECT_EQ(T::Combine(T::Block(data.data(), 300), T::Block(&data[300], 700), 700),
+            T::Block(data.data(), data.size()));
+}
+
+TEST(CrcT, MatchesGenerated) {
+  ExpectMatchesGenerated<Crc8Darc>(&kCrc8DarcInfo);
+  ExpectMatchesGenerated<Crc8ICode>(&kCrc8ICodeInfo);
+  ExpectMatchesGenerated<Crc16Kermit>(&kCrc16KermitInfo);
+  ExpectMatchesGenerated<Crc16CcittFalse>(&kCrc16CcittFalseInfo);
+  ExpectMatchesGenerated<Crc32>(&kCrc32Info);
+  ExpectMatchesGenerated<Crc32Mpeg2>(&kCrc32Mpeg2Info);
+}
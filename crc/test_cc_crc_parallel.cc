@@ -0,0 +1,36 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "crc/cc_crc_parallel.h"
+#include "util/thread_pool.h"
+
+extern "C" {
+#include "crc/all_crcs.h"
+}
+
+using namespace crc;
+
+TEST(CrcParallel, BlockParallel) {
+  std::vector<uint8_t> data(100000);
+  uint32_t x = 1;
+  for (auto& byte : data) {
+    x = x * 1103515245 + 12345;
+    byte = static_cast<uint8_t>(x >> 16);
+  }
+
+  util::ThreadPool pool(4);
+  for (size_t len : {size_t{0}, size_t{1}, size_t{4095}, data.size()}) {
+    SCOPED_TRACE("Len: " + std::to_string(len));
+    EXPECT_EQ(BlockParallel<8>(&kCrc8DarcInfo, data.data(), len, pool, 1000),
+              Crc<8>::Block(&kCrc8DarcInfo, data.data(), len));
+    EXPECT_EQ(BlockParallel<16>(&kCrc16CcittFalseInfo, data.data(), len, pool, 1000),
+              Crc<16>::Block(&kCrc16CcittFalseInfo, data.data(), len));
+    EXPECT_EQ(BlockParallel(Crc<32>(&kCrc32Info), data.data(), len, pool, 1000),
+              Crc<32>::Block(&kCrc32Info, data.data(), len));
+    EXPECT_EQ(BlockParallel<32>(&kCrc32Mpeg2Info, data.data(), len, pool, 1000),
+              Crc<32>::Block(&kCrc32Mpeg2Info, data.data(), len));
+  }
+}
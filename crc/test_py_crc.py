@@ -1,5 +1,12 @@
+import array
+import threading
 import unittest
 
+try:
+  import numpy
+except ImportError:
+  numpy = None
+
 from crc import py_crc
 
 
@@ -45,6 +52,116 @@ class TestCrc(unittest.TestCase):
         self.assertNotEqual(crc.update(self.test_input[:4]), value)
         self.assertEqual(crc.update(self.test_input[4:]), value)
 
+  def test_block_long(self):
+    data = bytes((i * 7 + 3) % 256 for i in range(1000))
+    for crc, _ in self.crcs:
+      with self.subTest(crc=crc):
+        crc.reset()
+        for b in data:
+          expected = crc.update(b)
+        self.assertEqual(crc.block(data), expected)
+
+  def test_combine(self):
+    data = bytes((i * 7 + 3) % 256 for i in range(1000))
+    for crc, _ in self.crcs:
+      with self.subTest(crc=crc):
+        for split in (0, 1, 500, 999, 1000):
+          a, b = data[:split], data[split:]
+          self.assertEqual(crc.combine(crc.block(a), crc.block(b), len(b)), crc.block(data))
+
+  def test_buffer_types(self):
+    for buf_type in (bytes, bytearray, memoryview, lambda b: array.array('B', b)):
+      for crc, value in self.crcs:
+        with self.subTest(buf_type=buf_type, crc=crc):
+          self.assertEqual(crc.block(buf_type(self.test_input)), value)
+          crc.reset()
+          self.assertEqual(crc.update(buf_type(self.test_input)), value)
+
+  def test_info(self):
+    crc = py_crc.Crc(16, 'kCrc16CcittFalseInfo')
+    self.assertEqual(16, crc.info.bits)
+    self.assertEqual(0xFFFF, crc.info.initial_crc)
+    self.assertEqual(0x0000, crc.info.final_xor)
+    self.assertFalse(crc.info.lsb_first)
+
+    with self.assertRaises(AttributeError):
+      py_crc.Crc(16, 'kCrc16BogusInfo')
+    with self.assertRaises(ValueError):
+      py_crc.Crc(12, 'kCrc12Info')
+
+  def test_large_threaded(self):
+    # Large inputs are processed with the GIL released.
+    data = bytes((i * 7 + 3) % 256 for i in range(1 << 20))
+    crc = py_crc.Crc(32, 'kCrc32Info')
+    expected = crc.block(data)
+    results = []
+    threads = [threading.Thread(target=lambda: results.append(crc.block(data))) for _ in range(4)]
+    for thread in threads:
+      thread.start()
+    for thread in threads:
+      thread.join()
+    self.assertEqual([expected] * 4, results)
+
+
+@unittest.skipIf(numpy is None, 'numpy not available')
+class TestBlockMany(unittest.TestCase):
+
+  def setUp(self):
+    self.crcs = [
+        py_crc.Crc(8, 'kCrc8DarcInfo'),
+        py_crc.Crc(16, 'kCrc16KermitInfo'),
+        py_crc.Crc(32, 'kCrc32Info'),
+        py_crc.Crc(32, 'kCrc32Mpeg2Info'),
+    ]
+    rng = numpy.random.default_rng(1)
+    self.data = rng.integers(0, 256, 20000, dtype=numpy.uint8)
+
+  def test_records(self):
+    records = self.data[:1000 * 17].reshape(1000, 17)
+    for crc in self.crcs:
+      with self.subTest(crc=crc.info.name):
+        actual = crc.block_many(records)
+        self.assertEqual(numpy.dtype(f'uint{crc.bits}'), actual.dtype)
+        self.assertEqual([crc.block(record) for record in records], actual.tolist())
+
+  def test_strided_records(self):
+    # Every other row of the first 12 columns.
+    records = self.data[:400 * 20].reshape(400, 20)[::2, :12]
+    crc = self.crcs[2]
+    self.assertEqual([crc.block(record.tobytes()) for record in records],
+                     crc.block_many(records).tolist())
+
+  def test_structured_records(self):
+    records = numpy.frombuffer(self.data[:100 * 10].tobytes(), dtype=[('a', '<u4'), ('b', 'u1', 6)])
+    crc = self.crcs[1]
+    self.assertEqual([crc.block(record.tobytes()) for record in records],
+                     crc.block_many(records).tolist())
+
+  def test_offsets(self):
+    offsets = numpy.cumsum([0] + [i % 300 for i in range(200)])
+    for crc in self.crcs:
+      with self.subTest(crc=crc.info.name):
+        expected = [crc.block(self.data[a:b]) for a, b in zip(offsets[:-1], offsets[1:])]
+        self.assertEqual(expected, crc.block_many(self.data, offsets).tolist())
+        self.assertEqual(expected, crc.block_many(self.data.tobytes(), list(offsets)).tolist())
+
+  def test_empty(self):
+    crc = self.crcs[2]
+    self.assertEqual(0, len(crc.block_many(numpy.zeros((0, 8), dtype=numpy.uint8))))
+    self.assertEqual(0, len(crc.block_many(b'', [0])))
+    self.assertEqual([crc.block(b'')], crc.block_many(b'', [0, 0]).tolist())
+
+  def test_invalid(self):
+    crc = self.crcs[2]
+    with self.assertRaises(ValueError):
+      crc.block_many(b'1234', [0, 5])
+    with self.assertRaises(ValueError):
+      crc.block_many(b'1234', [2, 1])
+    with self.assertRaises(ValueError):
+      crc.block_many(b'1234', [])
+    with self.assertRaises(ValueError):
+      crc.block_many(numpy.zeros((4, 4, 4), dtype=numpy.uint8))
+
 
 if __name__ == '__main__':
   unittest.main()
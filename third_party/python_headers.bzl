@@ -0,0 +1,29 @@
+"""Headers of the local python3 for building CPython extensions."""
+
+def _python_headers_impl(repository_ctx):
+    python = repository_ctx.which("python3")
+    if not python:
+        fail("python3 not found on PATH.")
+
+    result = repository_ctx.execute([
+        python,
+        "-c",
+        "import sysconfig; print(sysconfig.get_paths()['include'])",
+    ])
+    if result.return_code:
+        fail("Failed to locate Python headers: " + result.stderr)
+
+    repository_ctx.symlink(result.stdout.strip(), "include")
+    repository_ctx.file("BUILD", """cc_library(
+    name = "python_headers",
+    hdrs = glob(["include/**/*.h"]),
+    includes = ["include"],
+    visibility = ["//visibility:public"],
+)
+""")
+
+python_headers = repository_rule(
+    implementation = _python_headers_impl,
+    environ = ["PATH"],
+    local = True,
+)
@@ -0,0 +1,84 @@
+#include "util/c_spsc_ring.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+bool SpscRingInit(SpscRingState *ring, uint8_t *buf, size_t size) {
+  if (size == 0 || (size & (size - 1))) {
+    return false;
+  }
+
+  ring->_buf = buf;
+  ring->_mask = size - 1;
+  __atomic_store_n(&ring->_head, 0, __ATOMIC_RELAXED);
+  ring->_cached_tail = 0;
+  __atomic_store_n(&ring->_tail, 0, __ATOMIC_RELAXED);
+  ring->_cached_head = 0;
+  return true;
+}
+
+size_t SpscRingWritePtr(SpscRingState *ring, uint8_t **ptr) {
+  const size_t head = __atomic_load_n(&ring->_head, __ATOMIC_RELAXED);
+  const size_t size = ring->_mask + 1;
+
+  const size_t offset = head & ring->_mask;
+  const size_t to_end = size - offset;
+  *ptr = ring->_buf + offset;
+
+  // Only reload the consumer's index when the cached view limits the span.
+  size_t free = size - (head - ring->_cached_tail);
+  if (free < to_end) {
+    ring->_cached_tail = __atomic_load_n(&ring->_tail, __ATOMIC_ACQUIRE);
+    free = size - (head - ring->_cached_tail);
+  }
+  return free < to_end ? free : to_end;
+}
+
+void SpscRingCommit(SpscRingState *ring, size_t len) {
+  const size_t head = __atomic_load_n(&ring->_head, __ATOMIC_RELAXED);
+  __atomic_store_n(&ring->_head, head + len, __ATOMIC_RELEASE);
+}
+
+size_t SpscRingWrite(SpscRingState *ring, const uint8_t *input_buf, size_t len) {
+  size_t written = 0;
+  // At most two spans, either side of the wrap.
+  for (int i = 0; i < 2 && written < len; ++i) {
+    uint8_t *ptr;
+    size_t span = SpscRingWritePtr(ring, &ptr);
+    span = span < len - written ? span : len - written;
+    memcpy(ptr, input_buf + written, span);
+    SpscRingCommit(ring, span);
+    written += span;
+  }
+  return written;
+}
+
+size_t SpscRingReadPtr(SpscRingState *ring, const uint8_t **ptr) {
+  const size_t tail = __atomic_load_n(&ring->_tail, __ATOMIC_RELAXED);
+  const size_t offset = tail & ring->_mask;
+  const size_t to_end = ring->_mask + 1 - offset;
+  *ptr = ring->_buf + offset;
+
+  // Only reload the producer's index when the cached view limits the span.
+  size_t used = ring->_cached_head - tail;
+  if (used < to_end) {
+    ring->_cached_head = __atomic_load_n(&ring->_head, __ATOMIC_ACQUIRE);
+    used = ring->_cached_head - tail;
+  }
+  return used < to_end ? used : to_end;
+}
+
+void SpscRingConsume(SpscRingState *ring, size_t len) {
+  const size_t tail = __atomic_load_n(&ring->_tail, __ATOMIC_RELAXED);
+  __atomic_store_n(&ring->_tail, tail + len, __ATOMIC_RELEASE);
+}
+
+size_t SpscRingUsed(const SpscRingState *ring) {
+  const size_t tail = __atomic_load_n(&ring->_tail, __ATOMIC_ACQUIRE);
+  const size_t head = __atomic_load_n(&ring->_head, __ATOMIC_ACQUIRE);
+  return head - tail;
+}
+
+size_t SpscRingSize(const SpscRingState *ring) { return ring->_mask + 1; }
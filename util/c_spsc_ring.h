@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Alignment separating the producer and consumer indices.  Override to save RAM on targets
+// without caches.
+#ifndef SPSC_RING_CACHE_LINE
+#define SPSC_RING_CACHE_LINE 64
+#endif
+
+// Wait-free single producer single consumer byte ring.  One thread (or ISR) may call the producer
+// functions and one other the consumer functions concurrently.  Data is exchanged in place through
+// contiguous spans of the buffer.
+typedef struct {
+  // Private.  Indices count bytes since init and are only accessed atomically.
+  uint8_t *_buf;
+  size_t _mask;
+
+  __attribute__((aligned(SPSC_RING_CACHE_LINE))) size_t _head;  // Written by producer.
+  size_t _cached_tail;  // Producer's last view of _tail.
+
+  __attribute__((aligned(SPSC_RING_CACHE_LINE))) size_t _tail;  // Written by consumer.
+  size_t _cached_head;  // Consumer's last view of _head.
+} SpscRingState;
+
+// Initialize ring over "buf".  Returns false unless "size" is a non-zero power of two.
+bool SpscRingInit(SpscRingState *ring, uint8_t *buf, size_t size);
+
+// Producer.  Store a pointer to the contiguous free space in "ptr" and return its length, which is
+// zero if the ring is full.
+size_t SpscRingWritePtr(SpscRingState *ring, uint8_t **ptr);
+
+// Producer.  Publish "len" bytes written at SpscRingWritePtr.
+void SpscRingCommit(SpscRingState *ring, size_t len);
+
+// Producer.  Copy as much of "input_buf" as fits into the ring.  Returns the number of bytes
+// written.
+size_t SpscRingWrite(SpscRingState *ring, const uint8_t *input_buf, size_t len);
+
+// Consumer.  Store a pointer to the contiguous readable data in "ptr" and return its length, which
+// is zero if the ring is empty.  The remainder of a wrapped span follows once it is consumed.
+size_t SpscRingReadPtr(SpscRingState *ring, const uint8_t **ptr);
+
+// Consumer.  Release "len" bytes read at SpscRingReadPtr.
+void SpscRingConsume(SpscRingState *ring, size_t len);
+
+// Number of readable bytes.  Exact when called by the producer or consumer while the other is
+// idle, otherwise a snapshot.
+size_t SpscRingUsed(const SpscRingState *ring);
+
+// Capacity of the ring.
+size_t SpscRingSize(const SpscRingState *ring);
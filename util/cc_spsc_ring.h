@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+extern "C" {
+#include "util/c_spsc_ring.h"
+}
+
+namespace util {
+
+// Wait-free single producer single consumer byte ring.  See c_spsc_ring.h.
+class SpscRing {
+ public:
+  // Non-allocating constructor.  Uses the largest power of two bytes of buf that fit in size, which
+  // must not be zero.
+  SpscRing(uint8_t *buf, size_t size) : buf_ptr_{buf} {
+    assert(size > 0);
+    Init(FloorPow2(size));
+  }
+
+  // Allocating constructor.  size is rounded up to a power of two.
+  explicit SpscRing(size_t size) : buf_{new uint8_t[CeilPow2(size)]}, buf_ptr_{buf_.get()} {
+    Init(CeilPow2(size));
+  }
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // Producer.  Contiguous free space, empty if full.
+  std::pair<uint8_t *, size_t> WriteSpan() {
+    uint8_t *ptr;
+    const size_t len = SpscRingWritePtr(&ring_, &ptr);
+    return {ptr, len};
+  }
+
+  // Producer.  Publish len bytes written to WriteSpan().
+  void Commit(size_t len) { SpscRingCommit(&ring_, len); }
+
+  // Producer.  Copy as much of the input as fits, returning the number of bytes written.
+  size_t Write(const uint8_t *input_buf, size_t len) {
+    return SpscRingWrite(&ring_, input_buf, len);
+  }
+
+  // Consumer.  Contiguous readable data, empty if empty.
+  std::pair<const uint8_t *, size_t> ReadSpan() {
+    const uint8_t *ptr;
+    const size_t len = SpscRingReadPtr(&ring_, &ptr);
+    return {ptr, len};
+  }
+
+  // Consumer.  Release len bytes read from ReadSpan().
+  void Consume(size_t len) { SpscRingConsume(&ring_, len); }
+
+  size_t Used() const { return SpscRingUsed(&ring_); }
+  size_t Size() const { return SpscRingSize(&ring_); }
+
+ private:
+  void Init(size_t size) {
+    [[maybe_unused]] const bool ok = SpscRingInit(&ring_, buf_ptr_, size);
+    assert(ok);
+  }
+
+  static size_t FloorPow2(size_t size) {
+    size_t pow2 = 1;
+    while (pow2 <= size / 2) {
+      pow2 *= 2;
+    }
+    return pow2;
+  }
+
+  static size_t CeilPow2(size_t size) {
+    size_t pow2 = 1;
+    while (pow2 < size) {
+      pow2 *= 2;
+    }
+    return pow2;
+  }
+
+  SpscRingState ring_;
+  std::unique_ptr<uint8_t[]> buf_;
+  uint8_t *const buf_ptr_;
+};
+
+}  // namespace util
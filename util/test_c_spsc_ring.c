@@ -0,0 +1,65 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "external/unity/src/unity.h"
+
+#include "util/c_spsc_ring.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void TestSpscRingInit(void) {
+  uint8_t buf[16];
+  SpscRingState ring;
+  TEST_ASSERT_FALSE(SpscRingInit(&ring, buf, 0));
+  TEST_ASSERT_FALSE(SpscRingInit(&ring, buf, 12));
+  TEST_ASSERT_TRUE(SpscRingInit(&ring, buf, 16));
+  TEST_ASSERT_EQUAL_INT32(16, SpscRingSize(&ring));
+  TEST_ASSERT_EQUAL_INT32(0, SpscRingUsed(&ring));
+}
+
+static void TestSpscRingSpans(void) {
+  uint8_t buf[8];
+  SpscRingState ring;
+  TEST_ASSERT_TRUE(SpscRingInit(&ring, buf, sizeof(buf)));
+
+  const uint8_t *read_ptr;
+  TEST_ASSERT_EQUAL_INT32(0, SpscRingReadPtr(&ring, &read_ptr));
+
+  uint8_t *write_ptr;
+  TEST_ASSERT_EQUAL_INT32(8, SpscRingWritePtr(&ring, &write_ptr));
+  TEST_ASSERT_EQUAL_PTR(buf, write_ptr);
+  memcpy(write_ptr, "abcdef", 6);
+  SpscRingCommit(&ring, 6);
+  TEST_ASSERT_EQUAL_INT32(6, SpscRingUsed(&ring));
+
+  TEST_ASSERT_EQUAL_INT32(6, SpscRingReadPtr(&ring, &read_ptr));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY((const uint8_t *)"abcdef", read_ptr, 6);
+  SpscRingConsume(&ring, 5);
+
+  // Free space wraps.
+  TEST_ASSERT_EQUAL_INT32(2, SpscRingWritePtr(&ring, &write_ptr));
+  TEST_ASSERT_EQUAL_PTR(&buf[6], write_ptr);
+  TEST_ASSERT_EQUAL_INT32(7, SpscRingWrite(&ring, (const uint8_t *)"ghijklmn", 8));
+  TEST_ASSERT_EQUAL_INT32(8, SpscRingUsed(&ring));
+  TEST_ASSERT_EQUAL_INT32(0, SpscRingWritePtr(&ring, &write_ptr));
+  TEST_ASSERT_EQUAL_INT32(0, SpscRingWrite(&ring, (const uint8_t *)"x", 1));
+
+  // Readable data wraps.
+  TEST_ASSERT_EQUAL_INT32(3, SpscRingReadPtr(&ring, &read_ptr));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY((const uint8_t *)"fgh", read_ptr, 3);
+  SpscRingConsume(&ring, 3);
+  TEST_ASSERT_EQUAL_INT32(5, SpscRingReadPtr(&ring, &read_ptr));
+  TEST_ASSERT_EQUAL_PTR(buf, read_ptr);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY((const uint8_t *)"ijklm", read_ptr, 5);
+  SpscRingConsume(&ring, 5);
+  TEST_ASSERT_EQUAL_INT32(0, SpscRingUsed(&ring));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(TestSpscRingInit);
+  RUN_TEST(TestSpscRingSpans);
+  return UNITY_END();
+}
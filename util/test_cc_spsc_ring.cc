@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "util/cc_spsc_ring.h"
+
+using namespace testing;
+using namespace util;
+
+TEST(SpscRing, Size) {
+  EXPECT_EQ(SpscRing(100).Size(), 128u);
+  EXPECT_EQ(SpscRing(128).Size(), 128u);
+
+  uint8_t buf[100];
+  EXPECT_EQ(SpscRing(buf, sizeof(buf)).Size(), 64u);
+  EXPECT_EQ(SpscRing(buf, 1).Size(), 1u);
+  EXPECT_DEBUG_DEATH(SpscRing(buf, 0), "size > 0");
+}
+
+TEST(SpscRing, Threads) {
+  constexpr size_t kLen = 1 << 20;
+  SpscRing ring(256);
+
+  std::thread producer([&ring] {
+    size_t i = 0;
+    while (i < kLen) {
+      auto [ptr, len] = ring.WriteSpan();
+      len = std::min(len, kLen - i);
+      for (size_t j = 0; j < len; ++j) {
+        ptr[j] = static_cast<uint8_t>(i++ * 7);
+      }
+      ring.Commit(len);
+      if (len == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  size_t i = 0;
+  bool ok = true;
+  while (i < kLen) {
+    auto [ptr, len] = ring.ReadSpan();
+    for (size_t j = 0; j < len; ++j) {
+      ok &= ptr[j] == static_cast<uint8_t>(i++ * 7);
+    }
+    ring.Consume(len);
+    if (len == 0) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(i, kLen);
+  EXPECT_EQ(ring.Used(), 0u);
+}
@@ -0,0 +1,47 @@
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "util/thread_pool.h"
+
+using namespace testing;
+using namespace util;
+
+TEST(ThreadPool, Size) {
+  EXPECT_EQ(ThreadPool(3).Size(), 3u);
+  EXPECT_GE(ThreadPool().Size(), 1u);
+}
+
+TEST(ThreadPool, SubmitRunsAllBeforeDestruction) {
+  std::atomic<int> count{0};
+  {
+    ThreadPool pool(4);
+    for (int i = 0; i < 100; ++i) {
+      pool.Submit([&count] { ++count; });
+    }
+  }
+  EXPECT_EQ(count, 100);
+}
+
+TEST(ThreadPool, ParallelFor) {
+  ThreadPool pool(4);
+  for (size_t n : {0u, 1u, 2u, 5u, 1000u}) {
+    SCOPED_TRACE("n: " + std::to_string(n));
+    std::vector<std::atomic<int>> hits(n);
+    pool.ParallelFor(n, [&hits](size_t i) { ++hits[i]; });
+    for (auto &hit : hits) {
+      EXPECT_EQ(hit, 1);
+    }
+  }
+}
+
+TEST(ThreadPool, NestedParallelFor) {
+  ThreadPool pool(2);
+  std::atomic<int> count{0};
+  pool.ParallelFor(8, [&](size_t) { pool.ParallelFor(8, [&](size_t) { ++count; }); });
+  EXPECT_EQ(count, 64);
+}
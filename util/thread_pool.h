@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Fixed size pool of worker threads executing submitted tasks in FIFO order.
+class ThreadPool {
+ public:
+  // num_threads of 0 uses the hardware concurrency.
+  explicit ThreadPool(size_t num_threads = 0) {
+    if (num_threads == 0) {
+      num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+      workers_.emplace_back([this] { Run(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Finishes all queued tasks before joining the workers.
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  size_t Size() const { return workers_.size(); }
+
+  void Submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+  // Calls fn(i) for every i in [0, n) and returns once all calls are complete.  Indices are handed
+  // out dynamically and the calling thread participates.  Helpers that are dequeued after the work
+  // has run out return immediately, so ParallelFor may be nested inside pool tasks.
+  template <typename F>
+  void ParallelFor(size_t n, F &&fn) {
+    struct State {
+      std::atomic<size_t> next{0};
+      std::mutex mutex;
+      std::condition_variable cv;
+      size_t active = 0;
+      bool closed = false;
+    };
+    auto state = std::make_shared<State>();
+
+    auto work = [&fn, n](State &s) {
+      for (size_t i = s.next.fetch_add(1); i < n; i = s.next.fetch_add(1)) {
+        fn(i);
+      }
+    };
+
+    const size_t helpers = n ? std::min(Size(), n - 1) : 0;
+    for (size_t i = 0; i < helpers; ++i) {
+      Submit([state, work] {
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (state->closed) {
+            return;
+          }
+          ++state->active;
+        }
+        work(*state);
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (--state->active == 0) {
+          state->cv.notify_all();
+        }
+      });
+    }
+
+    work(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->closed = true;
+    state->cv.wait(lock, [&state] { return state->active == 0; });
+  }
+
+ private:
+  void Run() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+};
+
+}  // namespace util